@@ -0,0 +1,277 @@
+/// ofxControlBench
+/* Throughput of the hot paths (update + out) for 1 to 100k instances of every control type.
+ * Build with CMake (see the CMakeLists.txt in the root folder) and run in Release mode:
+ *
+ * ofxControlBench [--quick] [--max <instances>] [--fast] [filter]
+ *
+ * --quick   1/10 of the work per measurement (for a quick check)
+ * --max     max. number of instances (default: 100000)
+ * --fast    use the FAST precision mode (see ofxControl::setPrecision)
+ * filter    only run the benchmarks whose name contains this string (e.g. "Osc")
+ *
+ * Every measurement updates all instances for a number of frames (at 60 fps) and reads their outputs;
+ * lines and clocks get new segments / clocks when they run out, so segment ends and events are included
+ * (line players loop over a shared envelope).
+ * The result is the best of 3 runs in nanoseconds per instance and frame. */
+
+#include "ofxControlUtils.h"
+#include "ofxLineEnvelope.h"
+#include "ofxOscBank.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int numRuns = 3;
+const int minFrames = 20;
+
+// total number of updates per measurement
+long workPerRun = 4000000;
+
+// keeps the compiler from optimizing away the outputs
+volatile float sink;
+
+// deterministic random numbers for the setup
+uint32_t counter = 0;
+float randomFloat(float lo, float hi){
+    return lo + (hi - lo) * ofxControlRandom::uniform(ofxControlRandom::hash(12345, counter++));
+}
+
+template<typename TSetup, typename TFrame>
+double measure(int n, TSetup&& setup, TFrame&& frame){
+    int numFrames = (int)std::max<long>(minFrames, workPerRun / n);
+    double best = 1e30;
+    for (int run = 0; run < numRuns; ++run){
+        setup();
+        // warm up caches and branch predictors
+        for (int i = 0; i < 2; ++i){
+            frame();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numFrames; ++i){
+            frame();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        best = std::min(best, ns / ((double)numFrames * n));
+    }
+    return best;
+}
+
+void report(const char* name, int n, double ns){
+    printf("%-24s %8d %10.2f %10.2f\n", name, n, ns, 1000.0 / ns);
+    fflush(stdout);
+}
+
+/*---------------------- benchmarks ------------------------*/
+
+double benchLine(int n){
+    std::vector<ofxLine> lines;
+    auto setup = [&](){
+        lines.clear();
+        lines.resize(n);
+        counter = 0;
+        for (auto& line : lines){
+            line.addSegment(randomFloat(0, 1), randomFloat(0.25f, 1.f));
+        }
+    };
+    auto frame = [&](){
+        float sum = 0;
+        for (auto& line : lines){
+            line.update();
+            sum += line.out();
+            if (line.isIdle()){
+                line.addSegment(randomFloat(0, 1), randomFloat(0.25f, 1.f));
+            }
+        }
+        sink = sum;
+    };
+    return measure(n, setup, frame);
+}
+
+double benchLinePlayer(int n){
+    // all players share a single envelope and loop over it
+    std::vector<ofxLineEnvelope::Segment> segments;
+    counter = 0;
+    for (int i = 0; i < 16; ++i){
+        segments.emplace_back(randomFloat(0, 1), randomFloat(0.25f, 1.f));
+    }
+    auto envelope = ofxLineEnvelope::create(0, segments);
+    std::vector<ofxLinePlayer> players;
+    auto setup = [&](){
+        players.clear();
+        players.resize(n);
+        for (auto& player : players){
+            player.setEnvelope(envelope);
+            player.setLoop(true);
+            player.setTime(randomFloat(0, (float)envelope->getDuration()));
+        }
+    };
+    auto frame = [&](){
+        float sum = 0;
+        for (auto& player : players){
+            player.update();
+            sum += player.out();
+        }
+        sink = sum;
+    };
+    return measure(n, setup, frame);
+}
+
+double benchMultiLine(int n){
+    const int numLines = 8;
+    std::vector<ofxMultiLine> lines;
+    std::vector<float> target(numLines);
+    auto newSegment = [&](ofxMultiLine& line){
+        for (auto& x : target){
+            x = randomFloat(0, 1);
+        }
+        line.addSegment(target, randomFloat(0.25f, 1.f));
+    };
+    auto setup = [&](){
+        lines.clear();
+        lines.resize(n);
+        counter = 0;
+        for (auto& line : lines){
+            line.setNumLines(numLines);
+            newSegment(line);
+        }
+    };
+    auto frame = [&](){
+        float sum = 0;
+        for (auto& line : lines){
+            line.update();
+            sum += line.data()[0];
+            if (line.isIdle()){
+                newSegment(line);
+            }
+        }
+        sink = sum;
+    };
+    return measure(n, setup, frame);
+}
+
+double benchClock(int n){
+    std::vector<ofxClock> clocks;
+    int fired = 0;
+    auto setup = [&](){
+        clocks.clear();
+        clocks.resize(n);
+        counter = 0;
+        for (auto& clock : clocks){
+            clock.add(randomFloat(0.1f, 0.5f), [&](){ ++fired; });
+        }
+    };
+    auto frame = [&](){
+        for (auto& clock : clocks){
+            clock.update();
+            if (clock.isIdle()){
+                clock.add(randomFloat(0.1f, 0.5f), [&](){ ++fired; });
+            }
+        }
+        sink = (float)fired;
+    };
+    return measure(n, setup, frame);
+}
+
+template<typename T>
+double benchOsc(int n){
+    std::vector<T> oscs;
+    auto setup = [&](){
+        oscs.clear();
+        oscs.resize(n);
+        counter = 0;
+        for (auto& osc : oscs){
+            osc.setFrequency(randomFloat(0.1f, 10.f));
+        }
+    };
+    auto frame = [&](){
+        float sum = 0;
+        for (auto& osc : oscs){
+            osc.update();
+            sum += osc.out();
+        }
+        sink = sum;
+    };
+    return measure(n, setup, frame);
+}
+
+double benchOscBank(int n, ofxOscWaveform waveform){
+    ofxOscBank bank;
+    std::vector<float> out(n);
+    auto setup = [&](){
+        bank.setNumVoices(n);
+        bank.init();
+        bank.setWaveforms(waveform);
+        counter = 0;
+        for (int i = 0; i < n; ++i){
+            bank.setFrequency(i, randomFloat(0.1f, 10.f));
+        }
+    };
+    auto frame = [&](){
+        bank.update();
+        bank.process(out.data());
+        sink = out[0];
+    };
+    return measure(n, setup, frame);
+}
+
+struct Benchmark {
+    const char* name;
+    double (*func)(int n);
+};
+
+const Benchmark benchmarks[] = {
+    { "ofxLine", benchLine },
+    { "ofxLinePlayer", benchLinePlayer },
+    { "ofxMultiLine (8)", benchMultiLine },
+    { "ofxClock", benchClock },
+    { "ofxSawOsc", benchOsc<ofxSawOsc> },
+    { "ofxSinOsc", benchOsc<ofxSinOsc> },
+    { "ofxCosOsc", benchOsc<ofxCosOsc> },
+    { "ofxPulseOsc", benchOsc<ofxPulseOsc> },
+    { "ofxTriOsc", benchOsc<ofxTriOsc> },
+    { "ofxNoiseOsc", benchOsc<ofxNoiseOsc> },
+    { "ofxMetro", benchOsc<ofxMetro> },
+    { "ofxOscBank (SIN)", [](int n){ return benchOscBank(n, ofxOscWaveform::SIN); } },
+    { "ofxOscBank (NOISE)", [](int n){ return benchOscBank(n, ofxOscWaveform::NOISE); } },
+};
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    int maxInstances = 100000;
+    std::string filter;
+    for (int i = 1; i < argc; ++i){
+        if (!strcmp(argv[i], "--quick")){
+            workPerRun /= 10;
+        } else if (!strcmp(argv[i], "--max") && i + 1 < argc){
+            maxInstances = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--fast")){
+            ofxControl::setPrecision(ofxControlPrecision::FAST);
+        } else if (argv[i][0] == '-'){
+            fprintf(stderr, "usage: %s [--quick] [--max <instances>] [--fast] [filter]\n", argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            filter = argv[i];
+        }
+    }
+    ofxControl::setFrameRate(60);
+
+    printf("instruction set: %s, precision: %s\n", ofxControlSimd::getName(ofxControlSimd::getInstructionSet()),
+           ofxControl::isFast() ? "FAST" : "PRECISE");
+    printf("%-24s %8s %10s %10s\n", "control", "count", "ns/update", "M/s");
+    for (auto& b : benchmarks){
+        if (!filter.empty() && !strstr(b.name, filter.c_str())){
+            continue;
+        }
+        for (int n = 1; n <= maxInstances; n *= 10){
+            report(b.name, n, b.func(n));
+        }
+    }
+    return EXIT_SUCCESS;
+}
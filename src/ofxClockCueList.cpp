@@ -0,0 +1,67 @@
+#include "ofxClockCueList.h"
+
+/// ofxClockCueList
+
+ofxClockCueListPtr ofxClockCueList::create(std::vector<ofxClockCue> list){
+    for (auto& cue : list){
+        cue.time = (cue.time >= 0.0) ? cue.time : 0.0;
+    }
+    std::stable_sort(list.begin(), list.end(),
+        [](const ofxClockCue& a, const ofxClockCue& b){ return a.time < b.time; });
+    std::shared_ptr<ofxClockCueList> cueList(new ofxClockCueList());
+    cueList->storage = std::move(list);
+    cueList->cues = cueList->storage.data();
+    cueList->numCues = cueList->storage.size();
+    return cueList;
+}
+
+ofxClockCueListPtr ofxClockCueList::load(const std::string& path){
+    auto file = ofxControlMappedFile::open(path);
+    if (!file){
+        return nullptr;
+    }
+    ofxControlFileHeader header;
+    auto records = _ofxControlReadFile(*file, ofxControlFileType::CUES, sizeof(ofxClockCue), header);
+    if (!records){
+        return nullptr;
+    }
+    std::shared_ptr<ofxClockCueList> cueList(new ofxClockCueList());
+    cueList->cues = static_cast<const ofxClockCue*>(records);
+    cueList->numCues = (size_t)header.count;
+    cueList->file = std::move(file);
+    return cueList;
+}
+
+bool ofxClockCueList::save(const std::string& path) const {
+    return _ofxControlWriteFile(path, ofxControlFileType::CUES, cues, sizeof(ofxClockCue), numCues, 0.0);
+}
+
+bool ofxClockCueList::isMapped() const {
+    return file != nullptr;
+}
+
+size_t ofxClockCueList::getNumCues() const {
+    return numCues;
+}
+
+const ofxClockCue& ofxClockCueList::getCue(size_t index) const {
+    return cues[index];
+}
+
+double ofxClockCueList::getDuration() const {
+    return numCues ? cues[numCues - 1].time : 0.0;
+}
+
+size_t ofxClockCueList::findCue(double t) const {
+    size_t lo = 0;
+    size_t hi = numCues;
+    while (lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if (cues[mid].time < t){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
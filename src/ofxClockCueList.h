@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofxControlUtils.h"
+#include "ofxControlMappedFile.h"
+#include <string>
+#include <type_traits>
+
+/// ofxClockCueList
+/* An immutable list of timed cues, sorted by time, which is played by ofxClock::setCues.
+ * Instead of adding every cue of a show as a separate clock, the clock walks through the list with a cursor,
+ * so playing costs O(1) per fired cue and nothing at all for the cues which are still ahead.
+ *
+ * Like ofxLineEnvelope, cue lists are shared by pointer (ofxClockCueListPtr) and can be saved to a binary file
+ * and mapped into memory later (see ofxControlMappedFile.h). Mapped cue lists are read directly from the file,
+ * so loading takes constant time and only the pages which are actually played become resident. */
+
+// the cues are the records of the binary file format (see ofxControlMappedFile.h)
+static_assert(sizeof(ofxClockCue) == 16, "ofxClockCue: unexpected size");
+static_assert(std::is_trivial<ofxClockCue>::value, "ofxClockCue: must be a trivial type");
+
+class ofxClockCueList {
+public:
+    // sort a list of cues by time (cues with the same time keep their order), negative times are set to 0
+    static ofxClockCueListPtr create(std::vector<ofxClockCue> cues);
+    // map a cue file written by 'save', returns nullptr if the file can't be opened or is not a valid cue file
+    static ofxClockCueListPtr load(const std::string& path);
+    // write the cue list to a binary file, returns false on failure
+    bool save(const std::string& path) const;
+    // true if the cues are read from a mapped file
+    bool isMapped() const;
+
+    size_t getNumCues() const;
+    // no range checking!
+    const ofxClockCue& getCue(size_t index) const;
+    // time of the last cue
+    double getDuration() const;
+    // index of the first cue at or after 't', or getNumCues() if there is none. O(log n) in the number of cues.
+    size_t findCue(double t) const;
+protected:
+    ofxClockCueList() {}
+    // points either to 'storage' or into the mapped file
+    const ofxClockCue* cues;
+    size_t numCues;
+    std::vector<ofxClockCue> storage;
+    ofxControlMappedFilePtr file;
+};
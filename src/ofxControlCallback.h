@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ofxControlPool.h"
+
+/// ofxControlCallback
+/* Type erased callable (like std::function<void()>), used for all events of ofxClock, ofxLine and ofxBaseOsc.
+ * Callables up to 'bufferSize' bytes are stored inline, so there is no allocation for member function events,
+ * variable events and lambdas with a few captures. Bigger callables are stored in a block from ofxControlPool.
+ * Calling the callback is a single indirect function call.
+ *
+ * Callables can either take no arguments or the time offset of the event (in seconds) within the current update:
+ * line.addOnSegmentEnd([](float offset){ ... }); // e.g. for scheduling audio or MIDI events with sub-frame accuracy
+ * The offset is 0 if the callback is called directly (see the event functions of the control objects).
+ *
+ * Two callbacks compare equal with 'matches' if they hold the same type and the type provides
+ * a member function 'bool matches(const T& other) const' which returns true (see ofxControlVarEvent).
+ * This is used for cancelling events by variable or member function. */
+
+class ofxControlCallback {
+public:
+    static const size_t bufferSize = 48;
+
+    ofxControlCallback() : invoker(nullptr), manager(nullptr) {}
+
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, ofxControlCallback>::value>::type>
+    ofxControlCallback(F&& func) : invoker(nullptr), manager(nullptr) {
+        typedef typename std::decay<F>::type TFunc;
+        static_assert(std::is_copy_constructible<TFunc>::value, "ofxControlCallback: callable must be copy constructible");
+        static_assert(alignof(TFunc) <= alignof(std::max_align_t), "ofxControlCallback: over-aligned callables are not supported");
+        // dispatch at compile time, so the inline branch is never instantiated for big callables
+        construct<TFunc>(std::forward<F>(func), std::integral_constant<bool, isInline<TFunc>()>());
+    }
+
+    ofxControlCallback(const ofxControlCallback& other) : invoker(nullptr), manager(nullptr) {
+        copyFrom(other);
+    }
+    ofxControlCallback(ofxControlCallback&& other) : invoker(nullptr), manager(nullptr) {
+        moveFrom(other);
+    }
+    ofxControlCallback& operator=(const ofxControlCallback& other){
+        if (this != &other){
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+    ofxControlCallback& operator=(ofxControlCallback&& other){
+        if (this != &other){
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    ~ofxControlCallback(){
+        reset();
+    }
+
+    // call the stored function (must not be empty!)
+    void operator()(){
+        invoker(&storage, 0.f);
+    }
+    // call the stored function with a time offset (ignored by functions without arguments)
+    void operator()(float offset){
+        invoker(&storage, offset);
+    }
+    explicit operator bool() const {
+        return invoker != nullptr;
+    }
+    // destroy the stored function
+    void reset(){
+        if (manager){
+            manager(DESTROY, &storage, nullptr);
+            invoker = nullptr;
+            manager = nullptr;
+        }
+    }
+    // check if both callbacks hold the same kind of event (see above)
+    bool matches(const ofxControlCallback& other) const {
+        return manager && manager == other.manager
+            && manager(COMPARE, const_cast<Storage*>(&storage), &other.storage);
+    }
+    // check if a callable of type T would be stored without allocation
+    template<typename T>
+    static constexpr bool isInline(){
+        return sizeof(T) <= bufferSize && std::is_nothrow_move_constructible<T>::value;
+    }
+private:
+    enum Op {
+        MOVE,
+        COPY,
+        DESTROY,
+        COMPARE
+    };
+    typedef typename std::aligned_storage<bufferSize, alignof(std::max_align_t)>::type Storage;
+    typedef void (*Invoker)(void* storage, float offset);
+    typedef bool (*Manager)(Op op, void* dst, const void* src);
+
+    Storage storage;
+    Invoker invoker;
+    Manager manager;
+
+    template<typename TFunc, typename F>
+    void construct(F&& func, std::true_type /* inline */){
+        new (&storage) TFunc(std::forward<F>(func));
+        invoker = &invokeInline<TFunc>;
+        manager = &manageInline<TFunc>;
+    }
+    template<typename TFunc, typename F>
+    void construct(F&& func, std::false_type /* heap */){
+        void* mem = ofxControlPool::allocate(sizeof(TFunc));
+        TFunc* ptr = new (mem) TFunc(std::forward<F>(func));
+        *reinterpret_cast<TFunc**>(&storage) = ptr;
+        invoker = &invokeHeap<TFunc>;
+        manager = &manageHeap<TFunc>;
+    }
+
+    void copyFrom(const ofxControlCallback& other){
+        if (other.manager){
+            other.manager(COPY, &storage, &other.storage);
+            invoker = other.invoker;
+            manager = other.manager;
+        }
+    }
+    void moveFrom(ofxControlCallback& other){
+        if (other.manager){
+            other.manager(MOVE, &storage, &other.storage);
+            invoker = other.invoker;
+            manager = other.manager;
+            other.invoker = nullptr;
+            other.manager = nullptr;
+        }
+    }
+
+    // compare if the type supports it, otherwise callbacks never match
+    template<typename T>
+    static auto compare(const T& a, const T& b, int) -> decltype(a.matches(b)) {
+        return a.matches(b);
+    }
+    template<typename T>
+    static bool compare(const T&, const T&, long){
+        return false;
+    }
+
+    // pass the offset if the function takes it
+    template<typename T>
+    static auto call(T& func, float offset, int) -> decltype(func(offset), void()) {
+        func(offset);
+    }
+    template<typename T>
+    static void call(T& func, float, long){
+        func();
+    }
+
+    template<typename T>
+    static void invokeInline(void* storage, float offset){
+        call(*static_cast<T*>(storage), offset, 0);
+    }
+    template<typename T>
+    static void invokeHeap(void* storage, float offset){
+        call(**static_cast<T**>(storage), offset, 0);
+    }
+    template<typename T>
+    static bool manageInline(Op op, void* dst, const void* src){
+        switch (op){
+        case MOVE:
+            // the source is destroyed after moving
+            new (dst) T(std::move(*static_cast<T*>(const_cast<void*>(src))));
+            static_cast<T*>(const_cast<void*>(src))->~T();
+            return true;
+        case COPY:
+            new (dst) T(*static_cast<const T*>(src));
+            return true;
+        case DESTROY:
+            static_cast<T*>(dst)->~T();
+            return true;
+        case COMPARE:
+            return compare(*static_cast<const T*>(dst), *static_cast<const T*>(src), 0);
+        }
+        return false;
+    }
+    template<typename T>
+    static bool manageHeap(Op op, void* dst, const void* src){
+        switch (op){
+        case MOVE:
+            // just steal the pointer
+            *static_cast<T**>(dst) = *static_cast<T* const*>(src);
+            return true;
+        case COPY:
+        {
+            void* mem = ofxControlPool::allocate(sizeof(T));
+            *static_cast<T**>(dst) = new (mem) T(**static_cast<T* const*>(src));
+            return true;
+        }
+        case DESTROY:
+        {
+            T* ptr = *static_cast<T**>(dst);
+            ptr->~T();
+            ofxControlPool::deallocate(ptr, sizeof(T));
+            return true;
+        }
+        case COMPARE:
+            return compare(**static_cast<T* const*>(dst), **static_cast<T* const*>(src), 0);
+        }
+        return false;
+    }
+};
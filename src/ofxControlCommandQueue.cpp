@@ -0,0 +1,71 @@
+#include "ofxControlCommandQueue.h"
+
+/// ofxControlCommandQueue
+
+ofxControlCommandQueue::ofxControlCommandQueue(size_t capacity)
+    : enqueuePos(0), dequeuePos(0) {
+    size_t n = 2;
+    while (n < capacity){
+        n <<= 1;
+    }
+    cells.reset(new Cell[n]);
+    mask = n - 1;
+    // the sequence number tells the state of a cell: == position: free, == position + 1: ready to be consumed
+    for (size_t i = 0; i < n; ++i){
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+ofxControlCommandQueue::~ofxControlCommandQueue(){
+}
+
+bool ofxControlCommandQueue::push(ofxControlCallback&& command){
+    Cell* cell;
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true){
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0){
+            // the cell is free, try to claim it
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+            // otherwise 'pos' has been updated by compare_exchange_weak
+        } else if (diff < 0){
+            return false; // full
+        } else {
+            // another producer has claimed the cell
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->command = std::move(command);
+    // publish
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+int ofxControlCommandQueue::drain(){
+    int count = 0;
+    for (size_t i = 0; i <= mask; ++i){
+        Cell& cell = cells[dequeuePos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1){
+            break; // empty (or the producer hasn't finished writing yet)
+        }
+        ofxControlCallback command = std::move(cell.command);
+        // give the cell back to the producers (for the next round)
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        command();
+        ++count;
+    }
+    return count;
+}
+
+bool ofxControlCommandQueue::empty() const {
+    return cells[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+}
+
+size_t ofxControlCommandQueue::capacity() const {
+    return mask + 1;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ofxControlCallback.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// ofxControlCommandQueue
+/* Lock-free queue for sending commands (function objects) to control objects from other threads,
+ * e.g. adding a line segment when a network message arrives:
+ *
+ * // network thread
+ * queue.push([=]{ line.addSegment(target, 0.5); });
+ * // update routine
+ * queue.drain(); // calls all pending commands
+ * line.update();
+ *
+ * Any number of threads can push (multiple producers), but only one thread may drain (single consumer).
+ * The queue is a bounded ring buffer (Dmitry Vyukov's algorithm): 'push' claims a slot with a single CAS and never
+ * waits for other threads, 'drain' doesn't have to synchronize with the producers at all except for reading the slot
+ * sequence numbers. Commands are stored inline in the cells, so the function object passed to 'push' must fit into
+ * the inline buffer of ofxControlCallback (checked at compile time). Bigger commands can be pushed as an ofxControlCallback,
+ * but then the caller allocates from ofxControlPool and 'drain' gives the block back, which takes the spin lock of
+ * its size class (and objects above 256 bytes use the system allocator), so this is not lock-free anymore.
+ * If the queue is full, 'push' returns false, so choose a capacity which can hold all commands of a frame.
+ *
+ * ofxControlRegistry has its own queue which is drained at the start of every update (see ofxControlRegistry::post). */
+
+class ofxControlCommandQueue {
+public:
+    // the capacity is rounded up to the next power of 2
+    ofxControlCommandQueue(size_t capacity = 1024);
+    ~ofxControlCommandQueue();
+    ofxControlCommandQueue(const ofxControlCommandQueue&) = delete;
+    ofxControlCommandQueue& operator=(const ofxControlCommandQueue&) = delete;
+
+    // add a command (thread safe, lock-free), returns false if the queue is full
+    template<typename TFunc>
+    bool push(TFunc&& func);
+    // add a prepared command (see above for callables which are not stored inline)
+    bool push(ofxControlCallback&& command);
+    /* call all pending commands in the order they have been pushed and return the number of commands.
+     * to avoid starvation, it stops after 'capacity' commands. only call it from one thread at a time! */
+    int drain();
+    // true if there are no pending commands (only reliable on the consumer thread)
+    bool empty() const;
+    size_t capacity() const;
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        ofxControlCallback command;
+    };
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // producers and consumer work on different cache lines
+    char padding1[64];
+    std::atomic<size_t> enqueuePos;
+    char padding2[64];
+    size_t dequeuePos;
+};
+
+template<typename TFunc>
+bool ofxControlCommandQueue::push(TFunc&& func){
+    typedef typename std::decay<TFunc>::type TCommand;
+    static_assert(std::is_same<TCommand, ofxControlCallback>::value || ofxControlCallback::isInline<TCommand>(),
+        "ofxControlCommandQueue: command is too big to be stored inline, push an ofxControlCallback instead");
+    return push(ofxControlCallback(std::forward<TFunc>(func)));
+}
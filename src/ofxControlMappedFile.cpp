@@ -0,0 +1,141 @@
+#include "ofxControlMappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// ofxControlMappedFile
+
+#ifdef _WIN32
+
+ofxControlMappedFilePtr ofxControlMappedFile::open(const std::string& path){
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE){
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0
+            || (uint64_t)size.QuadPart > (uint64_t)std::numeric_limits<size_t>::max()){
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping){
+        CloseHandle(file);
+        return nullptr;
+    }
+    const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!ptr){
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+    std::shared_ptr<ofxControlMappedFile> result(new ofxControlMappedFile());
+    result->ptr = ptr;
+    result->length = (size_t)size.QuadPart;
+    result->fileHandle = file;
+    result->mappingHandle = mapping;
+    return result;
+}
+
+ofxControlMappedFile::~ofxControlMappedFile(){
+    if (ptr){
+        UnmapViewOfFile(ptr);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+    }
+}
+
+#else
+
+ofxControlMappedFilePtr ofxControlMappedFile::open(const std::string& path){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0){
+        close(fd);
+        return nullptr;
+    }
+    void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after closing the file
+    close(fd);
+    if (ptr == MAP_FAILED){
+        return nullptr;
+    }
+    std::shared_ptr<ofxControlMappedFile> result(new ofxControlMappedFile());
+    result->ptr = ptr;
+    result->length = (size_t)st.st_size;
+    return result;
+}
+
+ofxControlMappedFile::~ofxControlMappedFile(){
+    if (ptr){
+        munmap(const_cast<void*>(ptr), length);
+    }
+}
+
+#endif
+
+
+/*-------------------------------------------------------------------*/
+
+/// ofxControl binary files
+
+bool _ofxControlWriteFile(const std::string& path, ofxControlFileType type, const void* records,
+                          uint32_t recordSize, uint64_t count, double value){
+    ofxControlFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "OFXC", 4);
+    header.byteOrder = ofxControlFileHeader::byteOrderMark;
+    header.version = ofxControlFileHeader::currentVersion;
+    header.type = type;
+    header.recordSize = recordSize;
+    header.count = count;
+    header.value = value;
+
+    FILE* fp = std::fopen(path.c_str(), "wb");
+    if (!fp){
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (ok && count > 0){
+        ok = std::fwrite(records, recordSize, (size_t)count, fp) == (size_t)count;
+    }
+    // fclose flushes, so it can fail as well
+    ok = (std::fclose(fp) == 0) && ok;
+    return ok;
+}
+
+const void* _ofxControlReadFile(const ofxControlMappedFile& file, ofxControlFileType type,
+                                uint32_t recordSize, ofxControlFileHeader& header){
+    if (file.size() < sizeof(header)){
+        return nullptr;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "OFXC", 4) != 0
+            || header.byteOrder != ofxControlFileHeader::byteOrderMark
+            || header.version != ofxControlFileHeader::currentVersion
+            || header.type != type
+            || header.recordSize != recordSize){
+        return nullptr;
+    }
+    // the file must hold all records (written this way to avoid an overflow in 'count * recordSize')
+    if (header.count > (file.size() - sizeof(header)) / recordSize){
+        return nullptr;
+    }
+    return static_cast<const char*>(file.data()) + sizeof(header);
+}
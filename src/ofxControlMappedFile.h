@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// ofxControlMappedFile
+/* A read-only memory mapping of a whole file (mmap on POSIX systems, CreateFileMapping on Windows).
+ * Opening a file only reserves address space: the OS loads the pages when they are touched for the first time
+ * and can drop them again under memory pressure, so a huge file costs next to nothing until it is actually played.
+ * Mappings are shared by pointer (ofxControlMappedFilePtr) and unmapped when the last user lets go of them. */
+
+class ofxControlMappedFile;
+typedef std::shared_ptr<const ofxControlMappedFile> ofxControlMappedFilePtr;
+
+class ofxControlMappedFile {
+public:
+    // map a file, returns nullptr if the file can't be opened or is empty
+    static ofxControlMappedFilePtr open(const std::string& path);
+    ~ofxControlMappedFile();
+    ofxControlMappedFile(const ofxControlMappedFile&) = delete;
+    ofxControlMappedFile& operator=(const ofxControlMappedFile&) = delete;
+
+    const void* data() const { return ptr; }
+    size_t size() const { return length; }
+private:
+    ofxControlMappedFile() {}
+    const void* ptr = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+
+/// ofxControl binary files
+/* The binary format of ofxLineEnvelope and ofxClockCueList (see 'load' and 'save'):
+ * a 40 byte header followed by 'count' fixed size records, in native byte order.
+ * The records are plain structs (ofxLineEnvelopeSegment and ofxClockCue), so they are used directly from the mapping
+ * without any parsing. Only the header is checked on load: checking the records would touch every page of the file. */
+
+enum class ofxControlFileType : uint32_t {
+    ENVELOPE = 1,
+    CUES = 2
+};
+
+struct ofxControlFileHeader {
+    static const uint32_t currentVersion = 1;
+    // written as 0x01020304, so files with a different byte order are rejected
+    static const uint32_t byteOrderMark = 0x01020304;
+    char magic[4]; // "OFXC"
+    uint32_t byteOrder;
+    uint32_t version;
+    ofxControlFileType type;
+    // size of a single record (checked on load)
+    uint32_t recordSize;
+    uint32_t reserved;
+    // number of records
+    uint64_t count;
+    // ENVELOPE: start value
+    double value;
+};
+
+static_assert(sizeof(ofxControlFileHeader) == 40, "ofxControlFileHeader: unexpected size");
+
+// write a header and the records to a file, returns false on failure
+bool _ofxControlWriteFile(const std::string& path, ofxControlFileType type, const void* records,
+                          uint32_t recordSize, uint64_t count, double value);
+// check the header of a mapped file, returns the records (and the header) or nullptr if the file is invalid
+const void* _ofxControlReadFile(const ofxControlMappedFile& file, ofxControlFileType type,
+                                uint32_t recordSize, ofxControlFileHeader& header);
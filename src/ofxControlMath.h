@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// the library doesn't depend on openFrameworks, so it can't use PI, TWO_PI and HALF_PI from ofConstants.h
+#define OFXCONTROL_PI 3.14159265358979323846
+#define OFXCONTROL_TWO_PI 6.28318530717958647693
+#define OFXCONTROL_HALF_PI 1.57079632679489661923
+
+/// ofxControlFastMath
+/* Fast polynomial approximations for the math functions used by oscillators and line shapes.
+ * They are used instead of the standard library when the precision mode is set to FAST (see ofxControl::setPrecision).
+ * The coefficients are minimax fits, the max. errors below were measured over the whole input range in single precision:
+ *
+ * sin2pi(x), cos2pi(x):  sin(2*PI*x) / cos(2*PI*x); absolute error < 1e-6 for |x| <= 1
+ *                        (for bigger x the error grows with the rounding error of the argument)
+ * exp2(x):               2^x for -126 <= x <= 127 (clamped); relative error < 2e-7
+ * log2(x):               x > 0 (normalized floats); absolute error < 6e-7 for 0.25 <= x <= 4, relative error < 6e-7
+ *                        elsewhere (the rounding of the result grows with the exponent)
+ * exp(x):                via exp2 (x * log2(e) is split in double precision); relative error < 2e-7
+ * pow(x, y):             x >= 0, via exp2(y * log2(x)); for x in [0, 1] and 1/16 <= y <= 16 (line shapes)
+ *                        the absolute error is < 1e-5
+ *
+ * This is plenty for visuals and lighting, but don't use it for anything which needs full float precision. */
+
+class ofxControlFastMath {
+public:
+    ofxControlFastMath() = delete;
+
+    static inline float sin2pi(float x){
+        // reduce to [-0.5, 0.5), then fold to [-0.25, 0.25] using the symmetry of the sine
+        float r = x - std::floor(x + 0.5f);
+        if (r > 0.25f){
+            r = 0.5f - r;
+        } else if (r < -0.25f){
+            r = -0.5f - r;
+        }
+        float r2 = r * r;
+        return r * (6.28316404f + r2 * (-41.3371424f + r2 * (81.3407693f + r2 * -70.9934365f)));
+    }
+
+    static inline float cos2pi(float x){
+        return sin2pi(x + 0.25f);
+    }
+
+    static inline float exp2(float x){
+        x = (x < -126.f) ? -126.f : ((x > 127.f) ? 127.f : x);
+        float xi = std::floor(x);
+        return exp2(xi, x - xi);
+    }
+
+    static inline float log2(float x){
+        int32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        float e = (float)(((bits >> 23) & 0xFF) - 127);
+        // mantissa in [1, 2)
+        bits = (bits & 0x007FFFFF) | 0x3F800000;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+        float t = m - 1.f;
+        return e + t * (1.44266783f + t * (-0.720585419f + t * (0.473553094f + t * (-0.325901039f
+                + t * (0.194292928f + t * (-0.0795567055f + t * 0.0155296222f))))));
+    }
+
+    static inline float exp(float x){
+        // split x * log2(e) in double precision, so the rounding error doesn't grow with |x|
+        double y = (double)x * 1.4426950408889634;
+        y = (y < -126.0) ? -126.0 : ((y > 127.0) ? 127.0 : y);
+        double yi = std::floor(y);
+        return exp2((float)yi, (float)(y - yi));
+    }
+
+    static inline float pow(float x, float y){
+        return (x > 0.f) ? exp2(y * log2(x)) : 0.f;
+    }
+private:
+    // 2^(xi + f) for a whole number xi in [-126, 127] and f in [0, 1]
+    static inline float exp2(float xi, float f){
+        float p = 0.999999925f + f * (0.693153073f + f * (0.240153617f
+                + f * (0.0558263187f + f * (0.00898933934f + f * 0.00187757698f))));
+        // multiply by 2^xi by adding to the exponent
+        int32_t bits;
+        std::memcpy(&bits, &p, sizeof(bits));
+        bits += (int32_t)((uint32_t)(int32_t)xi << 23);
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+};
+
+
+/// ofxControlRandom
+/* Counter based random numbers: the n-th number of a stream is a pure function of the stream key and n,
+ * so there is no generator state to share, lock or advance. Every object drawing random numbers
+ * has its own key and just counts, which keeps the results deterministic no matter in which order
+ * (or on which thread) the objects are updated, and makes it trivial to generate numbers for many objects in SIMD.
+ *
+ * 'hash' applies two rounds of a 32 bit integer hash (xorshift-multiply, the constants are from Chris Wellons'
+ * hash prospector). It is not suitable for cryptography, but passes for control signals. */
+
+class ofxControlRandom {
+public:
+    ofxControlRandom() = delete;
+
+    // bijective 32 bit mixing function
+    static inline uint32_t mix(uint32_t x){
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // the 'counter'-th random number of the stream 'key'. also used to derive keys (e.g. key = hash(seed, stream)).
+    static inline uint32_t hash(uint32_t key, uint32_t counter){
+        return mix(mix(counter ^ key) + key);
+    }
+
+    // random number in [0, 1) (24 bits)
+    static inline float uniform(uint32_t bits){
+        return (float)(bits >> 8) * (1.f / 16777216.f);
+    }
+
+    // value noise (0 - 1): linear interpolation between the random numbers 'index' and 'index + 1' of the stream 'key'
+    static inline float noise(uint32_t key, uint32_t index, float ramp){
+        float a = uniform(hash(key, index));
+        float b = uniform(hash(key, index + 1));
+        return a + (b - a) * ramp;
+    }
+
+    // normal distribution (mean 0, standard deviation 1) from two random numbers (Box-Muller)
+    static inline float normal(uint32_t bits1, uint32_t bits2){
+        float r = std::sqrt(-2.f * std::log(1.f - uniform(bits1))); // 1 - u is never 0
+        return r * std::cos(6.28318531f * uniform(bits2));
+    }
+};
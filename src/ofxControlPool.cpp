@@ -0,0 +1,165 @@
+#include "ofxControlPool.h"
+#include <atomic>
+#include <vector>
+
+/// ofxControlPool
+
+namespace {
+
+const size_t blockSizes[ofxControlPool::numSizeClasses] = { 16, 32, 64, 128, 256 };
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct SizeClass {
+    SizeClass() : freeList(nullptr), capacity(0), used(0), highWater(0) {
+        lock.clear();
+    }
+    std::atomic_flag lock;
+    FreeBlock* freeList;
+    std::vector<void*> chunks;
+    size_t capacity;
+    size_t used;
+    size_t highWater;
+};
+
+struct PoolState {
+    PoolState() : chunkSize(256), numOversize(0) {}
+    SizeClass classes[ofxControlPool::numSizeClasses];
+    std::atomic<size_t> chunkSize;
+    std::atomic<size_t> numOversize;
+};
+
+// constructed on first use, so the pool can be used by static objects
+PoolState& getState(){
+    static PoolState state;
+    return state;
+}
+
+int sizeClassIndex(size_t size){
+    for (int i = 0; i < ofxControlPool::numSizeClasses; ++i){
+        if (size <= blockSizes[i]){
+            return i;
+        }
+    }
+    return -1; // too big
+}
+
+class SpinLock {
+public:
+    SpinLock(std::atomic_flag& _flag) : flag(_flag) {
+        while (flag.test_and_set(std::memory_order_acquire)) {}
+    }
+    ~SpinLock(){
+        flag.clear(std::memory_order_release);
+    }
+private:
+    std::atomic_flag& flag;
+};
+
+// carve a new chunk into blocks and put them on the free list (lock must be held)
+void addChunk(SizeClass& sc, size_t blockSize, size_t numBlocks){
+    char* chunk = static_cast<char*>(::operator new(blockSize * numBlocks));
+    sc.chunks.push_back(chunk);
+    for (size_t i = 0; i < numBlocks; ++i){
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+        block->next = sc.freeList;
+        sc.freeList = block;
+    }
+    sc.capacity += numBlocks;
+}
+
+} // namespace
+
+void* ofxControlPool::allocate(size_t size){
+    int index = sizeClassIndex(size);
+    if (index < 0){
+        ++getState().numOversize;
+        return ::operator new(size);
+    }
+    PoolState& state = getState();
+    SizeClass& sc = state.classes[index];
+    SpinLock guard(sc.lock);
+    if (!sc.freeList){
+        addChunk(sc, blockSizes[index], state.chunkSize);
+    }
+    FreeBlock* block = sc.freeList;
+    sc.freeList = block->next;
+    if (++sc.used > sc.highWater){
+        sc.highWater = sc.used;
+    }
+    return block;
+}
+
+void ofxControlPool::deallocate(void* ptr, size_t size){
+    if (!ptr){
+        return;
+    }
+    int index = sizeClassIndex(size);
+    if (index < 0){
+        ::operator delete(ptr);
+        return;
+    }
+    SizeClass& sc = getState().classes[index];
+    SpinLock guard(sc.lock);
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = sc.freeList;
+    sc.freeList = block;
+    --sc.used;
+}
+
+void ofxControlPool::reserve(size_t size, size_t count){
+    int index = sizeClassIndex(size);
+    if (index >= 0){
+        SizeClass& sc = getState().classes[index];
+        SpinLock guard(sc.lock);
+        if (count > sc.capacity){
+            addChunk(sc, blockSizes[index], count - sc.capacity);
+        }
+    }
+}
+
+void ofxControlPool::setChunkSize(size_t numBlocks){
+    getState().chunkSize = (numBlocks > 0) ? numBlocks : 1;
+}
+
+size_t ofxControlPool::getChunkSize(){
+    return getState().chunkSize;
+}
+
+ofxControlPoolStats ofxControlPool::getStats(size_t size){
+    int index = sizeClassIndex(size);
+    if (index >= 0){
+        return getStatsForClass(index);
+    } else {
+        ofxControlPoolStats stats = {};
+        stats.blockSize = size;
+        return stats;
+    }
+}
+
+ofxControlPoolStats ofxControlPool::getStatsForClass(int index){
+    ofxControlPoolStats stats = {};
+    if (index >= 0 && index < numSizeClasses){
+        SizeClass& sc = getState().classes[index];
+        SpinLock guard(sc.lock);
+        stats.blockSize = blockSizes[index];
+        stats.capacity = sc.capacity;
+        stats.used = sc.used;
+        stats.highWater = sc.highWater;
+        stats.numChunks = sc.chunks.size();
+    }
+    return stats;
+}
+
+size_t ofxControlPool::getNumOversize(){
+    return getState().numOversize;
+}
+
+void ofxControlPool::resetHighWater(){
+    for (auto& sc : getState().classes){
+        SpinLock guard(sc.lock);
+        sc.highWater = sc.used;
+    }
+}
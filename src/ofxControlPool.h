@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// ofxControlPool
+/* Static class managing a shared pool of fixed size memory blocks for control events
+ * (callables which don't fit into the inline buffer of ofxControlCallback).
+ * Blocks are grouped into size classes (16, 32, 64, 128 and 256 bytes) and recycled through free lists,
+ * so once the high-water mark has been reached, scheduling events doesn't touch the system allocator anymore.
+ * Requests bigger than the largest size class are forwarded to operator new.
+ *
+ * Memory is requested from the system in chunks of blocks. You can preallocate blocks for a size class
+ * in the setup routine of your app, e.g. ofxControlPool::reserve(64, 10000);
+ * Chunks are never returned to the system.
+ *
+ * All functions are thread safe (each size class is protected by a spin lock). */
+
+struct ofxControlPoolStats {
+    // block size of the size class (in bytes)
+    size_t blockSize;
+    // number of blocks allocated from the system
+    size_t capacity;
+    // number of blocks in use
+    size_t used;
+    // max. number of blocks in use at the same time
+    size_t highWater;
+    // number of chunks requested from the system
+    size_t numChunks;
+};
+
+class ofxControlPool {
+public:
+    ofxControlPool() = delete;
+    // number of size classes
+    static const int numSizeClasses = 5;
+    // get a block for an object of the given size
+    static void* allocate(size_t size);
+    // give a block back to the pool (size must be the same as for 'allocate')
+    static void deallocate(void* ptr, size_t size);
+    // make sure that at least 'count' blocks of a size class are available
+    static void reserve(size_t size, size_t count);
+    // set the number of blocks per chunk for subsequent allocations (default: 256)
+    static void setChunkSize(size_t numBlocks);
+    static size_t getChunkSize();
+    // get the statistics of the size class for a certain object size
+    static ofxControlPoolStats getStats(size_t size);
+    // get the statistics for size class 'index' (0 - 4)
+    static ofxControlPoolStats getStatsForClass(int index);
+    // number of allocations which were too big for the pool
+    static size_t getNumOversize();
+    // set all high-water marks to the current number of used blocks
+    static void resetHighWater();
+};
+
@@ -0,0 +1,135 @@
+#include "ofxControlRegistry.h"
+#include <algorithm>
+
+/// ofxControlRegistry
+
+namespace {
+    // number of controls a worker takes at once
+    const size_t parallelGrain = 64;
+}
+
+ofxControlRegistry::ofxControlRegistry(size_t commandQueueSize)
+    : sinks(1), bTimeOrdered(false), commandQueue(commandQueueSize) {
+}
+
+ofxControlRegistry::~ofxControlRegistry(){
+    clear();
+}
+
+ofxControlCommandQueue& ofxControlRegistry::getCommandQueue(){
+    return commandQueue;
+}
+
+void ofxControlRegistry::update(){
+    commandQueue.drain();
+    if (threadPool || bTimeOrdered){
+        updateDeferred();
+    } else {
+        for (auto& g : groups){
+            g.group->update();
+        }
+    }
+}
+
+void ofxControlRegistry::updateDeferred(){
+    // lay out all active controls in a single index range
+    groupOffsets.resize(groups.size() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < groups.size(); ++i){
+        groupOffsets[i] = total;
+        total += groups[i].group->beginUpdate();
+    }
+    groupOffsets[groups.size()] = total;
+
+    auto updateChunk = [this](size_t begin, size_t end, int worker){
+        _ofxControlEventSink& sink = sinks[worker];
+        ofxControl::_sink = &sink;
+        // find the first group and walk over the groups covered by the chunk
+        size_t g = std::upper_bound(groupOffsets.begin(), groupOffsets.end(), begin) - groupOffsets.begin() - 1;
+        while (begin < end){
+            size_t groupEnd = std::min(end, groupOffsets[g + 1]);
+            if (begin < groupEnd){
+                groups[g].group->updateRange(begin - groupOffsets[g], groupEnd - groupOffsets[g],
+                                             (uint32_t)groupOffsets[g], sink);
+                begin = groupEnd;
+            }
+            ++g;
+        }
+        ofxControl::_sink = nullptr;
+    };
+    if (threadPool){
+        threadPool->parallelFor(total, parallelGrain, updateChunk);
+    } else if (total > 0){
+        updateChunk(0, total, 0);
+    }
+
+    for (auto& g : groups){
+        g.group->endUpdate();
+    }
+
+    // call the collected events in time order. events at the same time are called in update order,
+    // so the order doesn't depend on the number of threads.
+    for (auto& sink : sinks){
+        for (auto& e : sink.events){
+            deferredEvents.push_back(std::move(e));
+        }
+        sink.events.clear();
+    }
+    std::sort(deferredEvents.begin(), deferredEvents.end(),
+              [](const _ofxControlDeferredEvent& a, const _ofxControlDeferredEvent& b){
+        if (a.offset != b.offset){
+            return a.offset < b.offset;
+        }
+        return (a.control != b.control) ? (a.control < b.control) : (a.sequence < b.sequence);
+    });
+    for (auto& e : deferredEvents){
+        e.callback(e.offset);
+    }
+    deferredEvents.clear();
+}
+
+void ofxControlRegistry::setNumThreads(int numThreads){
+    if (numThreads == 1){
+        threadPool.reset();
+        sinks.resize(1);
+    } else if (numThreads != getNumThreads() || numThreads == 0){
+        threadPool.reset(new ofxControlThreadPool(numThreads));
+        sinks.clear();
+        sinks.resize(threadPool->getNumThreads());
+    }
+}
+
+int ofxControlRegistry::getNumThreads() const {
+    return threadPool ? threadPool->getNumThreads() : 1;
+}
+
+void ofxControlRegistry::setTimeOrdered(bool ordered){
+    bTimeOrdered = ordered;
+}
+
+bool ofxControlRegistry::isTimeOrdered() const {
+    return bTimeOrdered || threadPool;
+}
+
+void ofxControlRegistry::clear(){
+    // destroy in reverse order of creation
+    while (!groups.empty()){
+        groups.pop_back();
+    }
+}
+
+int ofxControlRegistry::getNumControls() const {
+    size_t n = 0;
+    for (auto& g : groups){
+        n += g.group->size();
+    }
+    return (int)n;
+}
+
+int ofxControlRegistry::getNumActive() const {
+    size_t n = 0;
+    for (auto& g : groups){
+        n += g.group->numActive();
+    }
+    return (int)n;
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "ofxControlUtils.h"
+#include "ofxControlThreadPool.h"
+#include "ofxControlCommandQueue.h"
+#include <deque>
+#include <memory>
+#include <typeindex>
+
+/// ofxControlRegistry
+/* Updates many control objects in a single call.
+ * Controls are grouped by their concrete type (e.g. all ofxLine objects in one group, all ofxSinOsc objects in another)
+ * and each group is updated in a tight loop with non-virtual calls to T::update(). The update() of the built-in controls
+ * calls their own update(dt) directly, custom controls which only implement update(dt) get the (virtual) default
+ * of ofxBaseControl, unless they implement update() the same way.
+ * Every control advances by the frame duration of its own time domain (see ofxControlTimeDomain),
+ * so controls running at different rates should be kept in different registries.
+ *
+ * The registry can own the controls ('create' / 'destroy'); these are stored in contiguous chunks per type
+ * and slots of destroyed controls are reused. Controls owned by your app can be registered with 'add' / 'remove'.
+ * A control unregisters itself when it is destroyed and the registry unregisters all remaining controls
+ * when it goes away, so you don't have to worry about the order of destruction.
+ *
+ * Only controls in the 'active set' are updated: lines without segments, clocks without pending clocks
+ * and paused controls (see isIdle()) are dropped from the active set after an update and don't cost anything
+ * until they are woken up again by 'addSegment', 'add' (ofxClock) or 'resume'.
+ *
+ * By default, the events are called while the controls are updated, i.e. in the order of the controls.
+ * With 'setTimeOrdered', the events of all controls are collected and called after all controls have been updated,
+ * sorted by the exact time within the update at which they happened (see the 'offset' argument in ofxControlCallback).
+ * Events at the same time are called in the update order of the controls (and the order in which each control fired them).
+ * Use this if the events are used for scheduling, e.g. MIDI or audio events from a 60 Hz loop.
+ *
+ * With 'setNumThreads' the controls are updated in parallel on a thread pool (see ofxControlThreadPool).
+ * Because callbacks usually touch shared state of your app, events are *not* called on the worker threads:
+ * they are always collected and called in time order (as above) on the calling thread.
+ * So the order of the events doesn't depend on the number of threads or the scheduling.
+ * NOTE: when the events are collected, a callback adding a clock with zero delay or a segment with zero ramp time
+ * only takes effect on the next update.
+ * Controls registered in the same registry must not share state (e.g. custom controls writing to the same object).
+ *
+ * Other threads (e.g. network or audio threads) can send commands with 'post', which are called on the
+ * updating thread at the start of the next update (see ofxControlCommandQueue). This is the only
+ * function of the registry which may be called from other threads.
+ *
+ * NOTE: always use the concrete type for registering, otherwise the control ends up in the wrong group:
+ * ofxSinOsc osc; registry.add(&osc); // good
+ * ofxBaseOsc* p = &osc; registry.add(p); // bad: osc would be updated as ofxBaseOsc (wrong 'update' function)!
+ */
+
+// interface of the groups for ofxControlRegistry
+class _ofxControlGroupInterface : public _ofxControlGroupBase {
+public:
+    // update all active controls (serial)
+    virtual void update() = 0;
+    // parallel update: get the number of slots in the active set to update
+    virtual size_t beginUpdate() = 0;
+    // parallel update: update the active controls [begin, end). 'first' is the position of the group in the update order.
+    virtual void updateRange(size_t begin, size_t end, uint32_t first, _ofxControlEventSink& sink) = 0;
+    // parallel update: remove idle controls from the active set
+    virtual void endUpdate() = 0;
+    virtual size_t size() const = 0;
+    virtual size_t numActive() const = 0;
+};
+
+template<typename T>
+class _ofxControlGroup : public _ofxControlGroupInterface {
+public:
+    _ofxControlGroup() : activeCount(0) {}
+    ~_ofxControlGroup(){
+        // unregister the controls we don't own (the others are destroyed together with 'storage')
+        for (T* control : members){
+            ofxBaseControl* base = control;
+            base->controlGroup = nullptr;
+            base->bActive = false;
+        }
+    }
+    template<typename... Args>
+    T* create(Args&&... args){
+        T* control;
+        if (!freeList.empty()){
+            control = freeList.back();
+            freeList.pop_back();
+            control->~T();
+            new (control) T(std::forward<Args>(args)...);
+        } else {
+            storage.emplace_back(std::forward<Args>(args)...);
+            control = &storage.back();
+        }
+        add(control);
+        return control;
+    }
+    void destroy(T* control){
+        remove(control);
+        // keep the slot constructed, so 'storage' can always destroy all its elements
+        control->~T();
+        new (control) T();
+        freeList.push_back(control);
+    }
+    bool add(T* control){
+        ofxBaseControl* base = control;
+        if (base->controlGroup){
+            return false; // already registered
+        }
+        base->controlGroup = this;
+        base->groupIndex = (uint32_t)members.size();
+        base->bActive = false;
+        members.push_back(control);
+        if (!control->T::isIdle()){
+            activate(base);
+        }
+        return true;
+    }
+    bool remove(T* control){
+        ofxBaseControl* base = control;
+        if (base->controlGroup == this){
+            release(base);
+            return true;
+        } else {
+            return false;
+        }
+    }
+    void reserve(size_t n){
+        members.reserve(n);
+        active.reserve(n);
+    }
+
+    /* _ofxControlGroupInterface */
+    void update() override {
+        // controls which are woken up by callbacks are appended and only updated on the next call
+        size_t n = active.size();
+        for (size_t i = 0; i < n; ++i){
+            T* control = active[i];
+            if (control){
+                control->T::update();
+            }
+        }
+        endUpdate();
+    }
+    size_t beginUpdate() override {
+        return active.size();
+    }
+    void updateRange(size_t begin, size_t end, uint32_t first, _ofxControlEventSink& sink) override {
+        for (size_t i = begin; i < end; ++i){
+            T* control = active[i];
+            if (control){
+                sink.setControl(first + (uint32_t)i);
+                control->T::update();
+            }
+        }
+    }
+    void endUpdate() override {
+        // remove idle controls and holes from the active set (preserving the order)
+        size_t j = 0;
+        for (size_t i = 0; i < active.size(); ++i){
+            T* control = active[i];
+            if (control){
+                ofxBaseControl* base = control;
+                if (control->T::isIdle()){
+                    base->bActive = false;
+                    --activeCount;
+                } else {
+                    base->activeIndex = (uint32_t)j;
+                    active[j++] = control;
+                }
+            }
+        }
+        active.resize(j);
+    }
+    void activate(ofxBaseControl* base) override {
+        base->bActive = true;
+        base->activeIndex = (uint32_t)active.size();
+        active.push_back(static_cast<T*>(base));
+        ++activeCount;
+    }
+    void release(ofxBaseControl* base) override {
+        // leave a hole in the active set, it might be iterated over right now
+        if (base->bActive){
+            active[base->activeIndex] = nullptr;
+            --activeCount;
+        }
+        // move the last member into the free position
+        T* last = members.back();
+        members[base->groupIndex] = last;
+        static_cast<ofxBaseControl*>(last)->groupIndex = base->groupIndex;
+        members.pop_back();
+        base->controlGroup = nullptr;
+        base->bActive = false;
+    }
+    size_t size() const override {
+        return members.size();
+    }
+    size_t numActive() const override {
+        return activeCount;
+    }
+private:
+    // controls owned by the group (a deque never moves its elements)
+    std::deque<T> storage;
+    // destroyed controls in 'storage' which can be reused
+    std::vector<T*> freeList;
+    // all registered controls (owned or not)
+    std::vector<T*> members;
+    // controls to be updated, in activation order. removed controls leave a nullptr.
+    std::vector<T*> active;
+    size_t activeCount;
+};
+
+class ofxControlRegistry {
+public:
+    // 'commandQueueSize': max. number of pending commands (see 'post')
+    ofxControlRegistry(size_t commandQueueSize = 1024);
+    ~ofxControlRegistry();
+    ofxControlRegistry(const ofxControlRegistry&) = delete;
+    ofxControlRegistry& operator=(const ofxControlRegistry&) = delete;
+
+    // create a new control owned by the registry, passing the arguments to the constructor
+    template<typename T, typename... Args>
+    T* create(Args&&... args);
+    // destroy a control which has been created by the registry
+    template<typename T>
+    void destroy(T* control);
+    // register a control owned by somebody else, returns false if it is already registered
+    template<typename T>
+    bool add(T* control);
+    // unregister a control, returns false if it hasn't been registered (with this type)
+    template<typename T>
+    bool remove(T* control);
+    // preallocate space for a number of controls of a certain type
+    template<typename T>
+    void reserve(int numControls);
+
+    // send a command (any function object, see ofxControlCommandQueue::push) from any thread.
+    // it is called at the start of the next update. returns false if the command queue is full.
+    template<typename TFunc>
+    bool post(TFunc&& func);
+    ofxControlCommandQueue& getCommandQueue();
+
+    // call the pending commands and update all active controls
+    void update();
+    /* set the number of threads for 'update' (including the calling thread).
+     * 1 (default) updates all controls on the calling thread, 0 uses one thread per hardware core. */
+    void setNumThreads(int numThreads);
+    int getNumThreads() const;
+    // call the events in time order after all controls have been updated (always true with more than one thread)
+    void setTimeOrdered(bool ordered);
+    bool isTimeOrdered() const;
+    // unregister all controls and destroy the ones owned by the registry
+    void clear();
+    // number of registered controls
+    int getNumControls() const;
+    // number of controls in the active set
+    int getNumActive() const;
+private:
+    struct Group {
+        std::type_index type;
+        std::unique_ptr<_ofxControlGroupInterface> group;
+    };
+    // groups in order of creation
+    std::vector<Group> groups;
+    // parallel update
+    std::unique_ptr<ofxControlThreadPool> threadPool;
+    // one per thread
+    std::vector<_ofxControlEventSink> sinks;
+    // start of each group in the update order (plus the total count)
+    std::vector<size_t> groupOffsets;
+    std::vector<_ofxControlDeferredEvent> deferredEvents;
+    bool bTimeOrdered;
+    ofxControlCommandQueue commandQueue;
+    void updateDeferred();
+    template<typename T>
+    _ofxControlGroup<T>& getGroup();
+    template<typename T>
+    _ofxControlGroup<T>* findGroup();
+};
+
+template<typename T>
+_ofxControlGroup<T>& ofxControlRegistry::getGroup(){
+    _ofxControlGroup<T>* group = findGroup<T>();
+    if (!group){
+        group = new _ofxControlGroup<T>();
+        groups.push_back(Group{ std::type_index(typeid(T)), std::unique_ptr<_ofxControlGroupInterface>(group) });
+    }
+    return *group;
+}
+
+template<typename T>
+_ofxControlGroup<T>* ofxControlRegistry::findGroup(){
+    // there are only a handful of types, so a linear search is fine
+    for (auto& g : groups){
+        if (g.type == std::type_index(typeid(T))){
+            return static_cast<_ofxControlGroup<T>*>(g.group.get());
+        }
+    }
+    return nullptr;
+}
+
+template<typename T, typename... Args>
+T* ofxControlRegistry::create(Args&&... args){
+    return getGroup<T>().create(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void ofxControlRegistry::destroy(T* control){
+    if (auto group = findGroup<T>()){
+        group->destroy(control);
+    }
+}
+
+template<typename T>
+bool ofxControlRegistry::add(T* control){
+    return getGroup<T>().add(control);
+}
+
+template<typename T>
+bool ofxControlRegistry::remove(T* control){
+    auto group = findGroup<T>();
+    return group ? group->remove(control) : false;
+}
+
+template<typename TFunc>
+bool ofxControlRegistry::post(TFunc&& func){
+    return commandQueue.push(std::forward<TFunc>(func));
+}
+
+template<typename T>
+void ofxControlRegistry::reserve(int numControls){
+    getGroup<T>().reserve(std::max(0, numControls));
+}
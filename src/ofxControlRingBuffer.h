@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/// ofxControlRingBuffer
+/* Contiguous double ended queue with a power-of-two capacity, used as the segment queue of ofxLine and ofxMultiLine.
+ * Elements are *not* destroyed when they are popped, the slots are reused by following pushes.
+ * This way, elements which own memory (e.g. the value vectors of ofxMultiLineSegment) keep their capacity
+ * and a queue in steady state doesn't allocate at all.
+ *
+ * By default the buffer grows when it is full. With a fixed capacity, pushing to a full buffer fails instead,
+ * which makes the queue safe to use from real-time threads (after calling 'reserve'). */
+
+template<typename T>
+class ofxControlRingBuffer {
+public:
+    ofxControlRingBuffer() : head(0), count(0), mask(0), bFixed(false) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == buffer.size(); }
+    size_t capacity() const { return buffer.size(); }
+
+    // access elements relative to the front
+    T& operator[](size_t i) { return buffer[(head + i) & mask]; }
+    const T& operator[](size_t i) const { return buffer[(head + i) & mask]; }
+    T& front() { return buffer[head]; }
+    const T& front() const { return buffer[head]; }
+    T& back() { return (*this)[count - 1]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    // append a new element and return the slot so it can be filled in place.
+    // the slot still holds the contents of a previously popped element (or a default constructed one)!
+    // returns nullptr if the capacity is fixed and the buffer is full.
+    T* push_back(){
+        if (full()){
+            if (bFixed){
+                return nullptr;
+            }
+            grow(buffer.empty() ? 4 : buffer.size() * 2);
+        }
+        ++count;
+        return &back();
+    }
+    bool push_back(const T& value){
+        T* slot = push_back();
+        if (slot){
+            *slot = value;
+        }
+        return slot != nullptr;
+    }
+    bool push_back(T&& value){
+        T* slot = push_back();
+        if (slot){
+            *slot = std::move(value);
+        }
+        return slot != nullptr;
+    }
+    void pop_front(){
+        if (count){
+            head = (head + 1) & mask;
+            --count;
+        }
+    }
+    void pop_back(){
+        if (count){
+            --count;
+        }
+    }
+    void clear(){
+        head = 0;
+        count = 0;
+    }
+    // make room for at least n elements (rounded up to a power of two)
+    void reserve(size_t n){
+        if (n > buffer.size()){
+            size_t newSize = 4;
+            while (newSize < n){
+                newSize *= 2;
+            }
+            grow(newSize);
+        }
+    }
+    // with a fixed capacity, 'push_back' fails on a full buffer instead of allocating more memory
+    void setFixedCapacity(bool fixed) { bFixed = fixed; }
+    bool isFixedCapacity() const { return bFixed; }
+private:
+    void grow(size_t newSize){
+        std::vector<T> newBuffer(newSize);
+        // move the elements, so that the front is at index 0 again
+        for (size_t i = 0; i < buffer.size(); ++i){
+            std::swap(newBuffer[i], buffer[(head + i) & mask]);
+        }
+        buffer.swap(newBuffer);
+        head = 0;
+        mask = newSize - 1;
+    }
+    std::vector<T> buffer;
+    size_t head;
+    size_t count;
+    size_t mask;
+    bool bFixed;
+};
@@ -0,0 +1,641 @@
+#include "ofxControlSimd.h"
+#include "ofxControlMath.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define OFXCONTROL_X86 1
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+    #define OFXCONTROL_TARGET_SSE2
+    #define OFXCONTROL_TARGET_AVX2
+  #else
+    #define OFXCONTROL_TARGET_SSE2 __attribute__((target("sse2")))
+    #define OFXCONTROL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+  #endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+  #define OFXCONTROL_NEON 1
+  #include <arm_neon.h>
+#endif
+
+/// ofxControlSimd
+
+namespace {
+
+/*------------------- scalar ---------------------*/
+
+void lerpScalar(float* dst, const float* a, const float* b, float t, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        dst[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+void fracScalar(float* dst, const float* a, const float* b, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        float x = a[i] + b[i];
+        dst[i] = x - std::floor(x);
+    }
+}
+
+void phasorScalar(float* phase, const float* freq, float scale, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        float x = phase[i] + freq[i] * scale;
+        phase[i] = x - std::floor(x);
+    }
+}
+
+void phaseRampScalar(float* dst, float start, float inc, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        float x = start + (float)i * inc;
+        dst[i] = x - std::floor(x);
+    }
+}
+
+void sin2piScalar(float* dst, const float* x, float shift, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        dst[i] = ofxControlFastMath::sin2pi(x[i] + shift);
+    }
+}
+
+void noiseScalar(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n){
+    for (size_t i = 0; i < n; ++i){
+        dst[i] = ofxControlRandom::noise(ofxControlRandom::hash(key, first + (uint32_t)i), index[i], ramp[i]);
+    }
+}
+
+// coefficients of ofxControlFastMath::sin2pi
+#define OFXCONTROL_SIN_C1 6.28316404f
+#define OFXCONTROL_SIN_C3 -41.3371424f
+#define OFXCONTROL_SIN_C5 81.3407693f
+#define OFXCONTROL_SIN_C7 -70.9934365f
+
+/*------------------- x86 ------------------------*/
+
+#if OFXCONTROL_X86
+
+OFXCONTROL_TARGET_SSE2
+void lerpSse2(float* dst, const float* a, const float* b, float t, size_t n){
+    __m128 vt = _mm_set1_ps(t);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        __m128 a0 = _mm_loadu_ps(a + i);
+        __m128 a1 = _mm_loadu_ps(a + i + 4);
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(b + i), a0);
+        __m128 d1 = _mm_sub_ps(_mm_loadu_ps(b + i + 4), a1);
+        _mm_storeu_ps(dst + i, _mm_add_ps(a0, _mm_mul_ps(d0, vt)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(a1, _mm_mul_ps(d1, vt)));
+    }
+    for (; i + 4 <= n; i += 4){
+        __m128 a0 = _mm_loadu_ps(a + i);
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(b + i), a0);
+        _mm_storeu_ps(dst + i, _mm_add_ps(a0, _mm_mul_ps(d0, vt)));
+    }
+    lerpScalar(dst + i, a + i, b + i, t, n - i);
+}
+
+/* NOTE: the AVX2 kernels clear the upper halves of the YMM registers (vzeroupper) before calling the scalar
+ * version for the remaining elements. if the scalar function is not inlined, it is plain SSE code, which runs very
+ * slowly while the upper halves are dirty (and the compiler doesn't insert vzeroupper before a tail call). */
+
+OFXCONTROL_TARGET_AVX2
+void lerpAvx2(float* dst, const float* a, const float* b, float t, size_t n){
+    __m256 vt = _mm256_set1_ps(t);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16){
+        __m256 a0 = _mm256_loadu_ps(a + i);
+        __m256 a1 = _mm256_loadu_ps(a + i + 8);
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(b + i), a0);
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(b + i + 8), a1);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(d0, vt, a0));
+        _mm256_storeu_ps(dst + i + 8, _mm256_fmadd_ps(d1, vt, a1));
+    }
+    for (; i + 8 <= n; i += 8){
+        __m256 a0 = _mm256_loadu_ps(a + i);
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(b + i), a0);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(d0, vt, a0));
+    }
+    _mm256_zeroupper();
+    lerpScalar(dst + i, a + i, b + i, t, n - i);
+}
+
+// floor for SSE2 (which has no rounding instruction): truncate and correct negative values
+OFXCONTROL_TARGET_SSE2
+inline __m128 floorSse2(__m128 x){
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.f)));
+}
+
+OFXCONTROL_TARGET_SSE2
+void fracSse2(float* dst, const float* a, const float* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128 x = _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        _mm_storeu_ps(dst + i, _mm_sub_ps(x, floorSse2(x)));
+    }
+    fracScalar(dst + i, a + i, b + i, n - i);
+}
+
+OFXCONTROL_TARGET_SSE2
+void phasorSse2(float* phase, const float* freq, float scale, size_t n){
+    __m128 vs = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128 x = _mm_add_ps(_mm_loadu_ps(phase + i), _mm_mul_ps(_mm_loadu_ps(freq + i), vs));
+        _mm_storeu_ps(phase + i, _mm_sub_ps(x, floorSse2(x)));
+    }
+    phasorScalar(phase + i, freq + i, scale, n - i);
+}
+
+OFXCONTROL_TARGET_SSE2
+void phaseRampSse2(float* dst, float start, float inc, size_t n){
+    const __m128 vinc = _mm_set1_ps(inc);
+    const __m128 vstart = _mm_set1_ps(start);
+    __m128 index = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+    const __m128 four = _mm_set1_ps(4.f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128 x = _mm_add_ps(vstart, _mm_mul_ps(index, vinc));
+        _mm_storeu_ps(dst + i, _mm_sub_ps(x, floorSse2(x)));
+        index = _mm_add_ps(index, four);
+    }
+    for (; i < n; ++i){
+        float x = start + (float)i * inc;
+        dst[i] = x - std::floor(x);
+    }
+}
+
+OFXCONTROL_TARGET_SSE2
+void sin2piSse2(float* dst, const float* x, float shift, size_t n){
+    const __m128 vshift = _mm_set1_ps(shift);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128 y = _mm_add_ps(_mm_loadu_ps(x + i), vshift);
+        // reduce to [-0.5, 0.5) and fold to [-0.25, 0.25]
+        __m128 r = _mm_sub_ps(y, floorSse2(_mm_add_ps(y, half)));
+        __m128 sign = _mm_and_ps(r, signMask);
+        __m128 a = _mm_andnot_ps(signMask, r);
+        a = _mm_min_ps(a, _mm_sub_ps(half, a));
+        r = _mm_or_ps(a, sign);
+        __m128 r2 = _mm_mul_ps(r, r);
+        __m128 p = _mm_add_ps(_mm_set1_ps(OFXCONTROL_SIN_C5), _mm_mul_ps(r2, _mm_set1_ps(OFXCONTROL_SIN_C7)));
+        p = _mm_add_ps(_mm_set1_ps(OFXCONTROL_SIN_C3), _mm_mul_ps(r2, p));
+        p = _mm_add_ps(_mm_set1_ps(OFXCONTROL_SIN_C1), _mm_mul_ps(r2, p));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(r, p));
+    }
+    sin2piScalar(dst + i, x + i, shift, n - i);
+}
+
+// 32 bit multiplication for SSE2 (which only has 32 x 32 -> 64 bit): multiply even and odd lanes separately
+OFXCONTROL_TARGET_SSE2
+inline __m128i mulloSse2(__m128i a, __m128i b){
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// ofxControlRandom::hash
+OFXCONTROL_TARGET_SSE2
+inline __m128i mixSse2(__m128i x){
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = mulloSse2(x, _mm_set1_epi32(0x7feb352d));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = mulloSse2(x, _mm_set1_epi32((int)0x846ca68bU));
+    return _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+}
+
+OFXCONTROL_TARGET_SSE2
+inline __m128i hashSse2(__m128i key, __m128i counter){
+    return mixSse2(_mm_add_epi32(mixSse2(_mm_xor_si128(counter, key)), key));
+}
+
+// ofxControlRandom::uniform
+OFXCONTROL_TARGET_SSE2
+inline __m128 uniformSse2(__m128i bits){
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(1.f / 16777216.f));
+}
+
+OFXCONTROL_TARGET_SSE2
+void noiseSse2(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n){
+    const __m128i vkey = _mm_set1_epi32((int)key);
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i voice = _mm_add_epi32(_mm_set1_epi32((int)first), _mm_setr_epi32(0, 1, 2, 3));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        __m128i k = hashSse2(vkey, voice);
+        __m128i idx = _mm_loadu_si128((const __m128i*)(index + i));
+        __m128 a = uniformSse2(hashSse2(k, idx));
+        __m128 b = uniformSse2(hashSse2(k, _mm_add_epi32(idx, one)));
+        _mm_storeu_ps(dst + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_loadu_ps(ramp + i))));
+        voice = _mm_add_epi32(voice, _mm_set1_epi32(4));
+    }
+    noiseScalar(dst + i, ramp + i, index + i, key, first + (uint32_t)i, n - i);
+}
+
+OFXCONTROL_TARGET_AVX2
+void fracAvx2(float* dst, const float* a, const float* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(x, _mm256_floor_ps(x)));
+    }
+    _mm256_zeroupper();
+    fracScalar(dst + i, a + i, b + i, n - i);
+}
+
+OFXCONTROL_TARGET_AVX2
+void phasorAvx2(float* phase, const float* freq, float scale, size_t n){
+    __m256 vs = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        __m256 x = _mm256_fmadd_ps(_mm256_loadu_ps(freq + i), vs, _mm256_loadu_ps(phase + i));
+        _mm256_storeu_ps(phase + i, _mm256_sub_ps(x, _mm256_floor_ps(x)));
+    }
+    _mm256_zeroupper();
+    phasorScalar(phase + i, freq + i, scale, n - i);
+}
+
+OFXCONTROL_TARGET_AVX2
+void phaseRampAvx2(float* dst, float start, float inc, size_t n){
+    const __m256 vinc = _mm256_set1_ps(inc);
+    const __m256 vstart = _mm256_set1_ps(start);
+    __m256 index = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+    const __m256 eight = _mm256_set1_ps(8.f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        // no FMA, so the result is the same as the scalar version
+        __m256 x = _mm256_add_ps(vstart, _mm256_mul_ps(index, vinc));
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(x, _mm256_floor_ps(x)));
+        index = _mm256_add_ps(index, eight);
+    }
+    for (; i < n; ++i){
+        float x = start + (float)i * inc;
+        dst[i] = x - std::floor(x);
+    }
+}
+
+OFXCONTROL_TARGET_AVX2
+void sin2piAvx2(float* dst, const float* x, float shift, size_t n){
+    const __m256 vshift = _mm256_set1_ps(shift);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(x + i), vshift);
+        // reduce to [-0.5, 0.5) and fold to [-0.25, 0.25]
+        __m256 r = _mm256_sub_ps(y, _mm256_floor_ps(_mm256_add_ps(y, half)));
+        __m256 sign = _mm256_and_ps(r, signMask);
+        __m256 a = _mm256_andnot_ps(signMask, r);
+        a = _mm256_min_ps(a, _mm256_sub_ps(half, a));
+        r = _mm256_or_ps(a, sign);
+        __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 p = _mm256_fmadd_ps(r2, _mm256_set1_ps(OFXCONTROL_SIN_C7), _mm256_set1_ps(OFXCONTROL_SIN_C5));
+        p = _mm256_fmadd_ps(r2, p, _mm256_set1_ps(OFXCONTROL_SIN_C3));
+        p = _mm256_fmadd_ps(r2, p, _mm256_set1_ps(OFXCONTROL_SIN_C1));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(r, p));
+    }
+    _mm256_zeroupper();
+    sin2piScalar(dst + i, x + i, shift, n - i);
+}
+
+OFXCONTROL_TARGET_AVX2
+inline __m256i mixAvx2(__m256i x){
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846ca68bU));
+    return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+OFXCONTROL_TARGET_AVX2
+inline __m256i hashAvx2(__m256i key, __m256i counter){
+    return mixAvx2(_mm256_add_epi32(mixAvx2(_mm256_xor_si256(counter, key)), key));
+}
+
+OFXCONTROL_TARGET_AVX2
+inline __m256 uniformAvx2(__m256i bits){
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 8)), _mm256_set1_ps(1.f / 16777216.f));
+}
+
+OFXCONTROL_TARGET_AVX2
+void noiseAvx2(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n){
+    const __m256i vkey = _mm256_set1_epi32((int)key);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i voice = _mm256_add_epi32(_mm256_set1_epi32((int)first), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        __m256i k = hashAvx2(vkey, voice);
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(index + i));
+        __m256 a = uniformAvx2(hashAvx2(k, idx));
+        __m256 b = uniformAvx2(hashAvx2(k, _mm256_add_epi32(idx, one)));
+        // no FMA, so the result is the same as the scalar version
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), _mm256_loadu_ps(ramp + i))));
+        voice = _mm256_add_epi32(voice, _mm256_set1_epi32(8));
+    }
+    _mm256_zeroupper();
+    noiseScalar(dst + i, ramp + i, index + i, key, first + (uint32_t)i, n - i);
+}
+
+bool cpuHasSse2(){
+#if defined(__x86_64__) || defined(_M_X64)
+    return true; // part of x86_64
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2(){
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7){
+        return false;
+    }
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 6) != 6){
+        return false; // the OS must save the YMM registers
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // OFXCONTROL_X86
+
+/*------------------- ARM ------------------------*/
+
+#if OFXCONTROL_NEON
+
+void lerpNeon(float* dst, const float* a, const float* b, float t, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8){
+        float32x4_t a0 = vld1q_f32(a + i);
+        float32x4_t a1 = vld1q_f32(a + i + 4);
+        float32x4_t d0 = vsubq_f32(vld1q_f32(b + i), a0);
+        float32x4_t d1 = vsubq_f32(vld1q_f32(b + i + 4), a1);
+        vst1q_f32(dst + i, vmlaq_n_f32(a0, d0, t));
+        vst1q_f32(dst + i + 4, vmlaq_n_f32(a1, d1, t));
+    }
+    for (; i + 4 <= n; i += 4){
+        float32x4_t a0 = vld1q_f32(a + i);
+        float32x4_t d0 = vsubq_f32(vld1q_f32(b + i), a0);
+        vst1q_f32(dst + i, vmlaq_n_f32(a0, d0, t));
+    }
+    lerpScalar(dst + i, a + i, b + i, t, n - i);
+}
+
+// floor without relying on ARMv8 rounding instructions: truncate and correct negative values
+inline float32x4_t floorNeon(float32x4_t x){
+    float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(x));
+    uint32x4_t gt = vcgtq_f32(t, x);
+    return vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(gt, vreinterpretq_u32_f32(vdupq_n_f32(1.f)))));
+}
+
+void fracNeon(float* dst, const float* a, const float* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        float32x4_t x = vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        vst1q_f32(dst + i, vsubq_f32(x, floorNeon(x)));
+    }
+    fracScalar(dst + i, a + i, b + i, n - i);
+}
+
+void phasorNeon(float* phase, const float* freq, float scale, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        float32x4_t x = vmlaq_n_f32(vld1q_f32(phase + i), vld1q_f32(freq + i), scale);
+        vst1q_f32(phase + i, vsubq_f32(x, floorNeon(x)));
+    }
+    phasorScalar(phase + i, freq + i, scale, n - i);
+}
+
+void phaseRampNeon(float* dst, float start, float inc, size_t n){
+    const float32x4_t vstart = vdupq_n_f32(start);
+    const float indices[4] = { 0.f, 1.f, 2.f, 3.f };
+    float32x4_t index = vld1q_f32(indices);
+    const float32x4_t four = vdupq_n_f32(4.f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        float32x4_t x = vaddq_f32(vstart, vmulq_n_f32(index, inc));
+        vst1q_f32(dst + i, vsubq_f32(x, floorNeon(x)));
+        index = vaddq_f32(index, four);
+    }
+    for (; i < n; ++i){
+        float x = start + (float)i * inc;
+        dst[i] = x - std::floor(x);
+    }
+}
+
+void sin2piNeon(float* dst, const float* x, float shift, size_t n){
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        float32x4_t y = vaddq_f32(vld1q_f32(x + i), vdupq_n_f32(shift));
+        // reduce to [-0.5, 0.5) and fold to [-0.25, 0.25]
+        float32x4_t r = vsubq_f32(y, floorNeon(vaddq_f32(y, half)));
+        uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(r), signMask);
+        float32x4_t a = vabsq_f32(r);
+        a = vminq_f32(a, vsubq_f32(half, a));
+        r = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), sign));
+        float32x4_t r2 = vmulq_f32(r, r);
+        float32x4_t p = vmlaq_n_f32(vdupq_n_f32(OFXCONTROL_SIN_C5), r2, OFXCONTROL_SIN_C7);
+        p = vmlaq_f32(vdupq_n_f32(OFXCONTROL_SIN_C3), r2, p);
+        p = vmlaq_f32(vdupq_n_f32(OFXCONTROL_SIN_C1), r2, p);
+        vst1q_f32(dst + i, vmulq_f32(r, p));
+    }
+    sin2piScalar(dst + i, x + i, shift, n - i);
+}
+
+inline uint32x4_t mixNeon(uint32x4_t x){
+    x = veorq_u32(x, vshrq_n_u32(x, 16));
+    x = vmulq_n_u32(x, 0x7feb352dU);
+    x = veorq_u32(x, vshrq_n_u32(x, 15));
+    x = vmulq_n_u32(x, 0x846ca68bU);
+    return veorq_u32(x, vshrq_n_u32(x, 16));
+}
+
+inline uint32x4_t hashNeon(uint32x4_t key, uint32x4_t counter){
+    return mixNeon(vaddq_u32(mixNeon(veorq_u32(counter, key)), key));
+}
+
+inline float32x4_t uniformNeon(uint32x4_t bits){
+    return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(bits, 8)), 1.f / 16777216.f);
+}
+
+void noiseNeon(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n){
+    const uint32x4_t vkey = vdupq_n_u32(key);
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32_t offsets[4] = { 0, 1, 2, 3 };
+    uint32x4_t voice = vaddq_u32(vdupq_n_u32(first), vld1q_u32(offsets));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4){
+        uint32x4_t k = hashNeon(vkey, voice);
+        uint32x4_t idx = vld1q_u32(index + i);
+        float32x4_t a = uniformNeon(hashNeon(k, idx));
+        float32x4_t b = uniformNeon(hashNeon(k, vaddq_u32(idx, one)));
+        // separate multiply and add, so the result is the same as the scalar version
+        vst1q_f32(dst + i, vaddq_f32(a, vmulq_f32(vsubq_f32(b, a), vld1q_f32(ramp + i))));
+        voice = vaddq_u32(voice, vdupq_n_u32(4));
+    }
+    noiseScalar(dst + i, ramp + i, index + i, key, first + (uint32_t)i, n - i);
+}
+
+#endif // OFXCONTROL_NEON
+
+/*------------------- dispatch -------------------*/
+
+struct KernelTable {
+    ofxControlIsa isa;
+    void (*lerp)(float* dst, const float* a, const float* b, float t, size_t n);
+    void (*frac)(float* dst, const float* a, const float* b, size_t n);
+    void (*phasor)(float* phase, const float* freq, float scale, size_t n);
+    void (*phaseRamp)(float* dst, float start, float inc, size_t n);
+    void (*sin2pi)(float* dst, const float* x, float shift, size_t n);
+    void (*noise)(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n);
+};
+
+KernelTable makeTable(ofxControlIsa isa){
+    KernelTable table;
+    table.isa = isa;
+    switch (isa){
+#if OFXCONTROL_X86
+    case ofxControlIsa::AVX2:
+        table.lerp = lerpAvx2;
+        table.frac = fracAvx2;
+        table.phasor = phasorAvx2;
+        table.phaseRamp = phaseRampAvx2;
+        table.sin2pi = sin2piAvx2;
+        table.noise = noiseAvx2;
+        break;
+    case ofxControlIsa::SSE2:
+        table.lerp = lerpSse2;
+        table.frac = fracSse2;
+        table.phasor = phasorSse2;
+        table.phaseRamp = phaseRampSse2;
+        table.sin2pi = sin2piSse2;
+        table.noise = noiseSse2;
+        break;
+#endif
+#if OFXCONTROL_NEON
+    case ofxControlIsa::NEON:
+        table.lerp = lerpNeon;
+        table.frac = fracNeon;
+        table.phasor = phasorNeon;
+        table.phaseRamp = phaseRampNeon;
+        table.sin2pi = sin2piNeon;
+        table.noise = noiseNeon;
+        break;
+#endif
+    default:
+        table.isa = ofxControlIsa::SCALAR;
+        table.lerp = lerpScalar;
+        table.frac = fracScalar;
+        table.phasor = phasorScalar;
+        table.phaseRamp = phaseRampScalar;
+        table.sin2pi = sin2piScalar;
+        table.noise = noiseScalar;
+        break;
+    }
+    return table;
+}
+
+ofxControlIsa bestIsa(){
+    const ofxControlIsa candidates[] = { ofxControlIsa::AVX2, ofxControlIsa::SSE2, ofxControlIsa::NEON };
+    for (auto isa : candidates){
+        if (ofxControlSimd::isSupported(isa)){
+            return isa;
+        }
+    }
+    return ofxControlIsa::SCALAR;
+}
+
+// selected on first use (thread safe initialization)
+KernelTable& getTable(){
+    static KernelTable table = makeTable(bestIsa());
+    return table;
+}
+
+} // namespace
+
+void ofxControlSimd::lerp(float* dst, const float* a, const float* b, float t, size_t n){
+    getTable().lerp(dst, a, b, t, n);
+}
+
+void ofxControlSimd::frac(float* dst, const float* a, const float* b, size_t n){
+    getTable().frac(dst, a, b, n);
+}
+
+void ofxControlSimd::phasor(float* phase, const float* freq, float scale, size_t n){
+    getTable().phasor(phase, freq, scale, n);
+}
+
+void ofxControlSimd::phaseRamp(float* dst, float start, float inc, size_t n){
+    getTable().phaseRamp(dst, start, inc, n);
+}
+
+void ofxControlSimd::sin2pi(float* dst, const float* x, float shift, size_t n){
+    getTable().sin2pi(dst, x, shift, n);
+}
+
+void ofxControlSimd::noise(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n){
+    getTable().noise(dst, ramp, index, key, first, n);
+}
+
+ofxControlIsa ofxControlSimd::getInstructionSet(){
+    return getTable().isa;
+}
+
+// NOTE: not thread safe, call this in the setup routine of your app
+bool ofxControlSimd::setInstructionSet(ofxControlIsa isa){
+    if (isSupported(isa)){
+        getTable() = makeTable(isa);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool ofxControlSimd::isSupported(ofxControlIsa isa){
+    switch (isa){
+    case ofxControlIsa::SCALAR:
+        return true;
+#if OFXCONTROL_X86
+    case ofxControlIsa::SSE2:
+        return cpuHasSse2();
+    case ofxControlIsa::AVX2:
+        return cpuHasAvx2();
+#endif
+#if OFXCONTROL_NEON
+    case ofxControlIsa::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* ofxControlSimd::getName(ofxControlIsa isa){
+    switch (isa){
+    case ofxControlIsa::SSE2:
+        return "SSE2";
+    case ofxControlIsa::AVX2:
+        return "AVX2";
+    case ofxControlIsa::NEON:
+        return "NEON";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#define OFXCONTROL_SIMD_ALIGNMENT 32
+
+/// ofxControlAlignedAllocator
+// STL allocator returning memory aligned to OFXCONTROL_SIMD_ALIGNMENT (enough for AVX).
+
+template<typename T>
+class ofxControlAlignedAllocator {
+public:
+    typedef T value_type;
+
+    ofxControlAlignedAllocator() {}
+    template<typename U>
+    ofxControlAlignedAllocator(const ofxControlAlignedAllocator<U>&) {}
+
+    T* allocate(size_t n){
+        // over-allocate and store the original pointer right before the aligned block
+        size_t size = n * sizeof(T) + OFXCONTROL_SIMD_ALIGNMENT + sizeof(void*);
+        char* raw = static_cast<char*>(::operator new(size));
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + OFXCONTROL_SIMD_ALIGNMENT - 1)
+                & ~(uintptr_t)(OFXCONTROL_SIMD_ALIGNMENT - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+    void deallocate(T* ptr, size_t){
+        if (ptr){
+            ::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+        }
+    }
+    template<typename U>
+    bool operator==(const ofxControlAlignedAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const ofxControlAlignedAllocator<U>&) const { return false; }
+};
+
+template<typename T>
+using ofxControlAlignedVector = std::vector<T, ofxControlAlignedAllocator<T>>;
+
+
+/// ofxControlSimd
+/* Static class with vectorized kernels for the control objects.
+ * There are implementations for AVX2 (+FMA) and SSE2 on x86, NEON on ARM and a plain scalar fallback.
+ * On first use, the widest instruction set supported by the CPU is selected at runtime.
+ * The kernels work on arbitrary pointers (unaligned loads), but perform best on memory
+ * aligned to OFXCONTROL_SIMD_ALIGNMENT (see ofxControlAlignedVector). */
+
+enum class ofxControlIsa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+class ofxControlSimd {
+public:
+    ofxControlSimd() = delete;
+    // dst[i] = a[i] + (b[i] - a[i]) * t
+    static void lerp(float* dst, const float* a, const float* b, float t, size_t n);
+    // dst[i] = fractional part of (a[i] + b[i]), i.e. wrapped to [0, 1)
+    static void frac(float* dst, const float* a, const float* b, size_t n);
+    // phase[i] = fractional part of (phase[i] + freq[i] * scale)
+    static void phasor(float* phase, const float* freq, float scale, size_t n);
+    // dst[i] = fractional part of (start + i * inc), i.e. a block of phases
+    static void phaseRamp(float* dst, float start, float inc, size_t n);
+    // dst[i] = sin(2 * PI * (x[i] + shift)), using the polynomial of ofxControlFastMath::sin2pi
+    static void sin2pi(float* dst, const float* x, float shift, size_t n);
+    /* value noise for a batch of random streams (see ofxControlRandom): the key of stream i is hash(key, first + i).
+     * dst[i] = interpolation between the random numbers index[i] and index[i] + 1 of stream i (0 - 1) by ramp[i] (linear) */
+    static void noise(float* dst, const float* ramp, const uint32_t* index, uint32_t key, uint32_t first, size_t n);
+    // get the instruction set currently used by the kernels
+    static ofxControlIsa getInstructionSet();
+    // force a certain instruction set (e.g. for benchmarking). returns false if the CPU doesn't support it.
+    static bool setInstructionSet(ofxControlIsa isa);
+    // check if the CPU supports an instruction set
+    static bool isSupported(ofxControlIsa isa);
+    // get the name of an instruction set
+    static const char* getName(ofxControlIsa isa);
+};
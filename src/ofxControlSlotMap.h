@@ -0,0 +1,250 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/// ofxControlHandle
+// lightweight reference to a pending event (clock, segment end or oscillator listener).
+// a handle stays valid until the event has fired or has been removed, afterwards it
+// simply refers to nothing because the slot generation has moved on.
+// default constructed handles are null and never refer to anything.
+
+struct ofxControlHandle {
+    ofxControlHandle() : index(0), generation(0) {}
+    ofxControlHandle(uint32_t _index, uint32_t _generation)
+        : index(_index), generation(_generation) {}
+    bool isNull() const { return generation == 0; }
+    bool operator==(const ofxControlHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const ofxControlHandle& other) const {
+        return !(*this == other);
+    }
+    uint32_t index;
+    uint32_t generation;
+};
+
+/// ofxControlSlotMap
+// stores values in reusable slots and hands out generation checked handles.
+// insert, erase and lookup are O(1). live slots are linked in insertion order,
+// so the oldest and newest element can be found in O(1) as well.
+// erasing while walking the list is safe as long as the next index is fetched
+// *before* the current element is erased (see clear() for an example).
+// slots are allocated in fixed size blocks, so inserting never moves the stored values.
+// while the map is held (see hold()), erased values stay alive and their slots are not reused,
+// so a stored callback can be called in place even if it adds or removes elements (including itself).
+
+template<typename T>
+class ofxControlSlotMap {
+public:
+    static const uint32_t npos = 0xFFFFFFFF;
+
+    ofxControlSlotMap() : numSlots(0), head(npos), tail(npos), count(0), holdDepth(0) {}
+    ofxControlSlotMap(const ofxControlSlotMap& other) : ofxControlSlotMap() {
+        *this = other;
+    }
+    ofxControlSlotMap(ofxControlSlotMap&& other) : ofxControlSlotMap() {
+        *this = std::move(other);
+    }
+    ofxControlSlotMap& operator=(const ofxControlSlotMap& other){
+        if (this != &other){
+            blocks.clear();
+            for (size_t i = 0; i < other.blocks.size(); ++i){
+                blocks.emplace_back(new Slot[blockSize]);
+                std::copy(other.blocks[i].get(), other.blocks[i].get() + blockSize, blocks[i].get());
+            }
+            numSlots = other.numSlots;
+            freeList = other.freeList;
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            holdDepth = 0;
+            deferred.clear();
+            // values which are only kept alive by the other map's hold
+            for (uint32_t index : other.deferred){
+                slot(index).value = T();
+                freeList.push_back(index);
+            }
+        }
+        return *this;
+    }
+    ofxControlSlotMap& operator=(ofxControlSlotMap&& other){
+        if (this != &other){
+            blocks = std::move(other.blocks);
+            numSlots = other.numSlots;
+            freeList = std::move(other.freeList);
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            holdDepth = 0;
+            deferred.clear();
+            for (uint32_t index : other.deferred){
+                slot(index).value = T();
+                freeList.push_back(index);
+            }
+            other.blocks.clear();
+            other.freeList.clear();
+            other.deferred.clear();
+            other.numSlots = 0;
+            other.head = other.tail = npos;
+            other.count = 0;
+            other.holdDepth = 0;
+        }
+        return *this;
+    }
+
+    // add a new value at the end of the insertion order
+    ofxControlHandle insert(T&& value){
+        uint32_t index;
+        if (!freeList.empty()){
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = numSlots++;
+            if (index >= capacity()){
+                blocks.emplace_back(new Slot[blockSize]);
+            }
+        }
+        Slot& s = slot(index);
+        s.value = std::move(value);
+        s.used = true;
+        s.prev = tail;
+        s.next = npos;
+        if (tail != npos){
+            slot(tail).next = index;
+        } else {
+            head = index;
+        }
+        tail = index;
+        ++count;
+        return ofxControlHandle(index, s.generation);
+    }
+    // check if the handle still refers to a live element
+    bool contains(ofxControlHandle h) const {
+        return h.index < numSlots && slot(h.index).used && slot(h.index).generation == h.generation;
+    }
+    // get the element for a handle (or nullptr if it's gone)
+    T* get(ofxControlHandle h){
+        return contains(h) ? &slot(h.index).value : nullptr;
+    }
+    const T* get(ofxControlHandle h) const {
+        return contains(h) ? &slot(h.index).value : nullptr;
+    }
+    // remove the element for a handle, returns false if it was already gone
+    bool erase(ofxControlHandle h){
+        if (contains(h)){
+            eraseAt(h.index);
+            return true;
+        } else {
+            return false;
+        }
+    }
+    // remove the element at a (live) slot index
+    void eraseAt(uint32_t index){
+        Slot& s = slot(index);
+        // unlink (the slot keeps its own links so an ongoing walk can continue)
+        if (s.prev != npos){
+            slot(s.prev).next = s.next;
+        } else {
+            head = s.next;
+        }
+        if (s.next != npos){
+            slot(s.next).prev = s.prev;
+        } else {
+            tail = s.prev;
+        }
+        s.used = false;
+        // a new generation invalidates all outstanding handles (skip 0, which means 'null')
+        if (++s.generation == 0){
+            s.generation = 1;
+        }
+        if (holdDepth > 0){
+            deferred.push_back(index);
+        } else {
+            s.value = T();
+            freeList.push_back(index);
+        }
+        --count;
+    }
+    // remove all elements (outstanding handles become invalid)
+    void clear(){
+        for (uint32_t i = head; i != npos; ){
+            uint32_t n = slot(i).next;
+            eraseAt(i);
+            i = n;
+        }
+    }
+    // preallocate slots
+    void reserve(size_t n){
+        while (capacity() < n){
+            blocks.emplace_back(new Slot[blockSize]);
+        }
+        freeList.reserve(n);
+    }
+    /* keep erased values alive (and their slots unused) until the matching release(), e.g. while calling
+     * the stored callbacks in place. holds can be nested, the values are destroyed by the last release(). */
+    void hold(){
+        ++holdDepth;
+    }
+    void release(){
+        if (--holdDepth == 0 && !deferred.empty()){
+            for (uint32_t index : deferred){
+                slot(index).value = T();
+                freeList.push_back(index);
+            }
+            deferred.clear();
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return blocks.size() * blockSize; }
+
+    // walking the elements in insertion order
+    uint32_t first() const { return head; }
+    uint32_t last() const { return tail; }
+    uint32_t next(uint32_t index) const { return slot(index).next; }
+    uint32_t prev(uint32_t index) const { return slot(index).prev; }
+    bool isUsed(uint32_t index) const { return slot(index).used; }
+    T& at(uint32_t index) { return slot(index).value; }
+    const T& at(uint32_t index) const { return slot(index).value; }
+    ofxControlHandle handle(uint32_t index) const {
+        return ofxControlHandle(index, slot(index).generation);
+    }
+private:
+    struct Slot {
+        Slot() : value(), generation(1), prev(npos), next(npos), used(false) {}
+        T value;
+        uint32_t generation;
+        uint32_t prev;
+        uint32_t next;
+        bool used;
+    };
+    static const uint32_t blockBits = 4;
+    static const uint32_t blockSize = 1 << blockBits;
+    Slot& slot(uint32_t index){
+        return blocks[index >> blockBits][index & (blockSize - 1)];
+    }
+    const Slot& slot(uint32_t index) const {
+        return blocks[index >> blockBits][index & (blockSize - 1)];
+    }
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    uint32_t numSlots;
+    std::vector<uint32_t> freeList;
+    uint32_t head;
+    uint32_t tail;
+    size_t count;
+    int holdDepth;
+    // erased while the map is held
+    std::vector<uint32_t> deferred;
+};
+
+template<typename T>
+const uint32_t ofxControlSlotMap<T>::npos;
+template<typename T>
+const uint32_t ofxControlSlotMap<T>::blockBits;
+template<typename T>
+const uint32_t ofxControlSlotMap<T>::blockSize;
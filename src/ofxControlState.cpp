@@ -0,0 +1,156 @@
+#include "ofxControlState.h"
+
+namespace {
+
+const uint32_t stateVersion = 1;
+const uint32_t byteOrderMark = 0x01020304;
+
+struct StateHeader {
+    char magic[4]; // "OFXS"
+    uint32_t byteOrder;
+    uint32_t version;
+    uint32_t numControls;
+};
+
+struct RecordHeader {
+    ofxControlStateType type;
+    uint32_t reserved;
+    // size of the record data (without the header)
+    uint64_t size;
+};
+
+} // namespace
+
+/// ofxControlStateWriter
+
+ofxControlStateWriter::ofxControlStateWriter(ofxControlResolver* _resolver)
+    : resolver(_resolver), current(nullptr), numControls(0), recordStart(0) {
+    StateHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "OFXS", 4);
+    header.byteOrder = byteOrderMark;
+    header.version = stateVersion;
+    header.numControls = 0; // updated in 'endRecord'
+    write(header);
+}
+
+void ofxControlStateWriter::write(const void* data, size_t size){
+    if (size > 0){
+        size_t pos = buffer.size();
+        buffer.resize(pos + size);
+        std::memcpy(&buffer[pos], data, size);
+    }
+}
+
+bool ofxControlStateWriter::writeEvent(ofxControlHandle handle, uint64_t& id){
+    id = resolver ? resolver->getId(current, handle) : 0;
+    if (id != 0){
+        write(id);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+size_t ofxControlStateWriter::reserveCount(){
+    size_t pos = buffer.size();
+    write((uint32_t)0);
+    return pos;
+}
+
+void ofxControlStateWriter::writeCount(size_t pos, uint32_t count){
+    std::memcpy(&buffer[pos], &count, sizeof(count));
+}
+
+void ofxControlStateWriter::beginRecord(ofxControlStateType type, const void* control){
+    RecordHeader header;
+    header.type = type;
+    header.reserved = 0;
+    header.size = 0; // updated in 'endRecord'
+    recordStart = buffer.size();
+    write(header);
+    current = control;
+}
+
+void ofxControlStateWriter::endRecord(){
+    uint64_t size = buffer.size() - recordStart - sizeof(RecordHeader);
+    std::memcpy(&buffer[recordStart + offsetof(RecordHeader, size)], &size, sizeof(size));
+    uint32_t count = ++numControls;
+    std::memcpy(&buffer[offsetof(StateHeader, numControls)], &count, sizeof(count));
+    current = nullptr;
+}
+
+/*-------------------------------------------------------------------*/
+
+/// ofxControlStateReader
+
+ofxControlStateReader::ofxControlStateReader(const void* data, size_t size, ofxControlResolver* _resolver)
+    : pos(static_cast<const uint8_t*>(data)), end(pos + size), limit(end),
+      resolver(_resolver), current(nullptr), numControls(0), bValid(false) {
+    StateHeader header;
+    if (data && read(header) && !std::memcmp(header.magic, "OFXS", 4)
+            && header.byteOrder == byteOrderMark && header.version == stateVersion){
+        numControls = header.numControls;
+        bValid = true;
+    } else {
+        pos = end;
+    }
+}
+
+bool ofxControlStateReader::read(void* data, size_t size){
+    if ((size_t)(limit - pos) < size){
+        return false;
+    }
+    std::memcpy(data, pos, size);
+    pos += size;
+    return true;
+}
+
+bool ofxControlStateReader::readCount(uint32_t& count, size_t itemSize){
+    // check the size first, so a corrupt count can't make us allocate lots of memory
+    return read(count) && (uint64_t)count * itemSize <= (uint64_t)(limit - pos);
+}
+
+bool ofxControlStateReader::readEvent(uint64_t& id, ofxControlCallback& callback){
+    if (!read(id)){
+        return false;
+    }
+    if (resolver){
+        callback = resolver->resolve(current, id);
+    } else {
+        callback.reset();
+    }
+    return true;
+}
+
+void ofxControlStateReader::restored(uint64_t id, ofxControlHandle handle){
+    if (resolver){
+        resolver->restored(current, id, handle);
+    }
+}
+
+bool ofxControlStateReader::beginRecord(ofxControlStateType type, const void* control){
+    RecordHeader header;
+    if (!bValid || !read(header) || header.size > (uint64_t)(end - pos)){
+        pos = end; // can't go on
+        return false;
+    }
+    limit = pos + header.size;
+    if (header.type != type){
+        // skip the record
+        pos = limit;
+        limit = end;
+        return false;
+    }
+    current = control;
+    return true;
+}
+
+bool ofxControlStateReader::endRecord(bool ok){
+    // the whole record must have been consumed
+    ok = ok && (pos == limit);
+    pos = limit;
+    limit = end;
+    current = nullptr;
+    return ok;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ofxControlUtils.h"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/// ofxControlState
+/* Snapshots of the complete state of control objects, e.g. for restarting a render node in the middle of a show:
+ *
+ * ofxControlStateWriter writer(&resolver);
+ * writer.save(line);
+ * writer.save(clocks.data(), clocks.size());
+ * send(writer.data()); // a versioned binary blob
+ *
+ * ofxControlStateReader reader(blob.data(), blob.size(), &resolver);
+ * reader.restore(line);
+ * reader.restore(clocks.data(), clocks.size());
+ *
+ * Controls are restored in the order in which they have been saved, into controls of the same type
+ * (see ofxControlStateType). A snapshot contains everything which changes while a control is running:
+ * ofxLine / ofxMultiLine: value(s), segment queue (including the elapsed time of the current segment) and shape,
+ * ofxClock: clock time and pending clocks, oscillators: phase, offset, counter, frequency and the phase mode (plus
+ * pulse width, vertex and the noise state), ofxTimer: elapsed time, and the speed and the running state of all controls.
+ * Settings of the receiving object (time domain, fixed capacity, registry membership) are kept,
+ * cue lists of ofxClock are not saved (set them again with ofxClock::setCues and a start time).
+ *
+ * Callbacks can't be serialized, so events are saved by id: ofxControlResolver::getId gives the id of an event handle
+ * when saving, and ofxControlResolver::resolve gives the callback for an id when restoring. Events without an id
+ * (or without a resolver) are not saved. The blob is written in native byte order. */
+
+enum class ofxControlStateType : uint32_t {
+    BASE = 1,
+    LINE,
+    MULTI_LINE,
+    CLOCK,
+    OSC,
+    PULSE_OSC,
+    TRI_OSC,
+    NOISE_OSC,
+    TIMER
+};
+
+// maps events to ids (and back) for snapshots. 'control' is the address of the control which is being saved or restored.
+class ofxControlResolver {
+public:
+    virtual ~ofxControlResolver() {}
+    // id of an event (0: don't save the event)
+    virtual uint64_t getId(const void* control, ofxControlHandle handle) = 0;
+    // callback for an id (an empty callback drops the event)
+    virtual ofxControlCallback resolve(const void* control, uint64_t id) = 0;
+    // called for every restored event with its new handle (the old handles are not valid anymore)
+    virtual void restored(const void* /* control */, uint64_t /* id */, ofxControlHandle /* handle */) {}
+};
+
+class ofxControlStateWriter {
+public:
+    ofxControlStateWriter(ofxControlResolver* resolver = nullptr);
+    // append the state of a control
+    template<typename T>
+    void save(const T& control);
+    // append the states of an array of controls
+    template<typename T>
+    void save(const T* controls, size_t count);
+    // the whole snapshot
+    const std::vector<uint8_t>& data() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    int getNumControls() const { return numControls; }
+
+    /* for implementing ofxBaseControl::saveState */
+    template<typename T>
+    void write(const T& value){
+        static_assert(std::is_trivially_copyable<T>::value, "ofxControlStateWriter: type must be trivially copyable");
+        write(&value, sizeof(T));
+    }
+    void write(const void* data, size_t size);
+    // write the id of an event (see ofxControlResolver::getId), returns false if the event is not saved
+    bool writeEvent(ofxControlHandle handle, uint64_t& id);
+    // write the number of saved events at a position returned by 'reserveCount' (see ofxLine::saveState)
+    size_t reserveCount();
+    void writeCount(size_t pos, uint32_t count);
+private:
+    std::vector<uint8_t> buffer;
+    ofxControlResolver* resolver;
+    const void* current;
+    int numControls;
+    size_t recordStart;
+    void beginRecord(ofxControlStateType type, const void* control);
+    void endRecord();
+};
+
+class ofxControlStateReader {
+public:
+    // the data must stay valid while restoring
+    ofxControlStateReader(const void* data, size_t size, ofxControlResolver* resolver = nullptr);
+    // false if the data is not a (compatible) snapshot
+    bool isValid() const { return bValid; }
+    int getNumControls() const { return numControls; }
+    // true if all controls have been read
+    bool atEnd() const { return pos == end; }
+    /* restore the next control. returns false if the snapshot holds a different type of control,
+     * or if the data is invalid (in this case the control might be partially restored). */
+    template<typename T>
+    bool restore(T& control);
+    // restore an array of controls, returns false if any of them has failed
+    template<typename T>
+    bool restore(T* controls, size_t count);
+
+    /* for implementing ofxBaseControl::restoreState */
+    template<typename T>
+    bool read(T& value){
+        static_assert(std::is_trivially_copyable<T>::value, "ofxControlStateReader: type must be trivially copyable");
+        return read(&value, sizeof(T));
+    }
+    bool read(void* data, size_t size);
+    // read a count and check that the record can hold (at least) 'count' items of 'itemSize' bytes
+    bool readCount(uint32_t& count, size_t itemSize);
+    // read an event id and resolve it ('callback' is empty if the event is dropped)
+    bool readEvent(uint64_t& id, ofxControlCallback& callback);
+    // tell the resolver about the new handle of a restored event
+    void restored(uint64_t id, ofxControlHandle handle);
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+    // end of the current record
+    const uint8_t* limit;
+    ofxControlResolver* resolver;
+    const void* current;
+    int numControls;
+    bool bValid;
+    bool beginRecord(ofxControlStateType type, const void* control);
+    bool endRecord(bool ok);
+};
+
+template<typename T>
+void ofxControlStateWriter::save(const T& control){
+    beginRecord(control.getStateType(), &control);
+    control.saveState(*this);
+    endRecord();
+}
+
+template<typename T>
+void ofxControlStateWriter::save(const T* controls, size_t count){
+    for (size_t i = 0; i < count; ++i){
+        save(controls[i]);
+    }
+}
+
+template<typename T>
+bool ofxControlStateReader::restore(T& control){
+    if (!beginRecord(control.getStateType(), &control)){
+        return false;
+    }
+    return endRecord(control.restoreState(*this));
+}
+
+template<typename T>
+bool ofxControlStateReader::restore(T* controls, size_t count){
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i){
+        ok = restore(controls[i]) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,100 @@
+#include "ofxControlThreadPool.h"
+#include <algorithm>
+
+/// ofxControlThreadPool
+
+ofxControlThreadPool::ofxControlThreadPool(int numThreads)
+    : job(nullptr), jobGrain(1), generation(0), numBusy(0), bQuit(false) {
+    if (numThreads <= 0){
+        numThreads = std::max<int>(1, std::thread::hardware_concurrency());
+    }
+    numWorkers = numThreads;
+    ranges.reset(new Range[numWorkers]);
+    for (int i = 0; i < numWorkers; ++i){
+        ranges[i].next = 0;
+        ranges[i].end = 0;
+    }
+    // worker 0 is the calling thread
+    for (int i = 1; i < numWorkers; ++i){
+        threads.emplace_back(&ofxControlThreadPool::threadFunction, this, i);
+    }
+}
+
+ofxControlThreadPool::~ofxControlThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bQuit = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& t : threads){
+        t.join();
+    }
+}
+
+int ofxControlThreadPool::getNumThreads() const {
+    return numWorkers;
+}
+
+void ofxControlThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, int)>& func){
+    grain = std::max<size_t>(1, grain);
+    if (count == 0){
+        return;
+    }
+    if (numWorkers == 1 || count <= grain){
+        // not worth waking up the other threads
+        func(0, count, 0);
+        return;
+    }
+    // split the range evenly
+    size_t chunk = (count + numWorkers - 1) / numWorkers;
+    for (int i = 0; i < numWorkers; ++i){
+        size_t begin = std::min(count, chunk * i);
+        ranges[i].next.store(begin, std::memory_order_relaxed);
+        ranges[i].end = std::min(count, begin + chunk);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &func;
+        jobGrain = grain;
+        numBusy = numWorkers - 1;
+        ++generation;
+    }
+    wakeCondition.notify_all();
+    work(0);
+    // wait for the other workers
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]{ return numBusy == 0; });
+    job = nullptr;
+}
+
+void ofxControlThreadPool::threadFunction(int worker){
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true){
+        wakeCondition.wait(lock, [&]{ return bQuit || generation != seen; });
+        if (bQuit){
+            return;
+        }
+        seen = generation;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if (--numBusy == 0){
+            doneCondition.notify_one();
+        }
+    }
+}
+
+void ofxControlThreadPool::work(int worker){
+    // start with the own range, then steal from the others
+    for (int k = 0; k < numWorkers; ++k){
+        Range& range = ranges[(worker + k) % numWorkers];
+        while (true){
+            size_t begin = range.next.fetch_add(jobGrain, std::memory_order_relaxed);
+            if (begin >= range.end){
+                break;
+            }
+            (*job)(begin, std::min(begin + jobGrain, range.end), worker);
+        }
+    }
+}
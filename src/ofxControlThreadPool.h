@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// ofxControlThreadPool
+/* A small work-stealing thread pool for data parallel loops (used by ofxControlRegistry).
+ * 'parallelFor' splits the index range evenly between the workers. Every worker has an atomic counter
+ * for its own range and takes chunks of 'grain' indices from it. A worker which has run out of work
+ * steals chunks from the ranges of the other workers, so uneven workloads still keep all cores busy.
+ *
+ * The calling thread takes part as worker 0, so a pool with N threads only starts N - 1 system threads.
+ * Idle workers sleep on a condition variable. */
+
+class ofxControlThreadPool {
+public:
+    // the number of threads includes the calling thread. 0 means one thread per hardware core.
+    ofxControlThreadPool(int numThreads = 0);
+    ~ofxControlThreadPool();
+    ofxControlThreadPool(const ofxControlThreadPool&) = delete;
+    ofxControlThreadPool& operator=(const ofxControlThreadPool&) = delete;
+
+    int getNumThreads() const;
+    /* call 'func(begin, end, worker)' for chunks of [0, count) on all workers and wait until everything is done.
+     * 'worker' is the index of the thread (0 to getNumThreads() - 1). */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, int)>& func);
+private:
+    // the range of a worker, on its own cache line to avoid false sharing
+    struct Range {
+        std::atomic<size_t> next;
+        size_t end;
+        char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    };
+    std::vector<std::thread> threads;
+    std::unique_ptr<Range[]> ranges;
+    int numWorkers;
+    // the current job
+    const std::function<void(size_t, size_t, int)>* job;
+    size_t jobGrain;
+    // synchronization
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    int numBusy;
+    bool bQuit;
+    void threadFunction(int worker);
+    void work(int worker);
+};
@@ -1,24 +1,55 @@
-#include "ofxControl.h"
+#include "ofxControlUtils.h"
+#include "ofxClockCueList.h"
+#include "ofxControlState.h"
+#include <iostream>
 
 /// ofxControl
 
 void ofxControl::setFrameRate(float fps) {
-    _fps = (fps > 0) ? fps : OFXCONTROL_DEFAULT_RATE;
+    _defaultDomain.setFrameRate(fps);
 }
 float ofxControl::getFrameRate() {
-    return _fps;
+    return _defaultDomain.getFrameRate();
 }
-float ofxControl::_fps = OFXCONTROL_DEFAULT_RATE;
+// constant initialized, so controls in global variables can safely point to it
+ofxControlTimeDomain ofxControl::_defaultDomain;
+
+void ofxControl::setPrecision(ofxControlPrecision precision){
+    _precision = precision;
+}
+ofxControlPrecision ofxControl::getPrecision(){
+    return _precision;
+}
+ofxControlPrecision ofxControl::_precision = ofxControlPrecision::PRECISE;
+
+void ofxControl::setSeed(uint32_t seed){
+    _seed.store(seed, std::memory_order_relaxed);
+}
+uint32_t ofxControl::getSeed(){
+    return _seed.load(std::memory_order_relaxed);
+}
+uint32_t ofxControl::newStream(){
+    return _numStreams.fetch_add(1, std::memory_order_relaxed);
+}
+std::atomic<uint32_t> ofxControl::_seed(0);
+std::atomic<uint32_t> ofxControl::_numStreams(0);
+thread_local _ofxControlEventSink* ofxControl::_sink = nullptr;
 
 /*---------------------------------------------------------------*/
 
 /// ofxBaseControl
 
-ofxBaseControl::ofxBaseControl(){
+ofxBaseControl::ofxBaseControl()
+    : timeDomain(&ofxControl::getDefaultTimeDomain()),
+      controlGroup(nullptr), bActive(false), groupIndex(0), activeIndex(0) {
     init();
 }
 
 ofxBaseControl::~ofxBaseControl(){
+    // unregister from ofxControlRegistry
+    if (controlGroup){
+        controlGroup->release(this);
+    }
 }
 
 void ofxBaseControl::init(){
@@ -41,14 +72,231 @@ void ofxBaseControl::pause(){
 
 void ofxBaseControl::resume(){
     bRunning = true;
+    wake();
 }
 
 bool ofxBaseControl::isRunning() const {
     return bRunning;
 }
 
+void ofxBaseControl::update(){
+    update((float)timeDomain->getDeltaTime());
+}
+
+void ofxBaseControl::setTimeDomain(ofxControlTimeDomain* domain){
+    timeDomain = domain ? domain : &ofxControl::getDefaultTimeDomain();
+}
+
+ofxControlTimeDomain* ofxBaseControl::getTimeDomain() const {
+    return timeDomain;
+}
+
+ofxControlStateType ofxBaseControl::getStateType() const {
+    return ofxControlStateType::BASE;
+}
+
+void ofxBaseControl::saveState(ofxControlStateWriter& writer) const {
+    writer.write(speed);
+    writer.write((uint8_t)bRunning);
+}
+
+bool ofxBaseControl::restoreState(ofxControlStateReader& reader){
+    float newSpeed;
+    uint8_t running;
+    if (!reader.read(newSpeed) || !reader.read(running)){
+        return false;
+    }
+    speed = newSpeed;
+    bRunning = running != 0;
+    if (bRunning){
+        wake();
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------*/
+
+/// _ofxLineShaper
+
+void _ofxLineShaper::prepare(ofxLineShape newShape, float coeff){
+    shape = newShape;
+    sc = norm = exponent = omega = 0.0;
+    switch (shape){
+    case ofxLineShape::FAST_EXP:
+    case ofxLineShape::SLOW_EXP:
+        if (coeff > 0.f){
+            sc = (shape == ofxLineShape::FAST_EXP) ? -coeff : coeff;
+            norm = 1.0 / (std::exp(sc) - 1.0);
+        } else {
+            shape = ofxLineShape::LIN; // no curvature
+        }
+        break;
+    case ofxLineShape::FAST_POW:
+        exponent = 1.0 / std::pow(2.0, coeff);
+        break;
+    case ofxLineShape::SLOW_POW:
+        exponent = std::pow(2.0, coeff);
+        break;
+    case ofxLineShape::FAST_COS:
+    case ofxLineShape::SLOW_COS:
+        omega = OFXCONTROL_HALF_PI;
+        break;
+    case ofxLineShape::S_CURVE:
+        omega = OFXCONTROL_PI;
+        break;
+    default:
+        break;
+    }
+    lastDelta = -1.f;
+    bValid = false;
+}
+
+float _ofxLineShaper::direct(float ramp) const {
+    if (ofxControl::isFast()){
+        switch (shape){
+        case ofxLineShape::STEP:
+            return 0.f;
+        case ofxLineShape::FAST_EXP:
+        case ofxLineShape::SLOW_EXP:
+            return (ofxControlFastMath::exp(sc * ramp) - 1.0) * norm;
+        case ofxLineShape::FAST_POW:
+        case ofxLineShape::SLOW_POW:
+            return ofxControlFastMath::pow(ramp, exponent);
+        case ofxLineShape::FAST_COS:
+            return ofxControlFastMath::sin2pi(0.25f * ramp);
+        case ofxLineShape::SLOW_COS:
+            return 1.f - ofxControlFastMath::cos2pi(0.25f * ramp);
+        case ofxLineShape::S_CURVE:
+            return 0.5f - 0.5f * ofxControlFastMath::cos2pi(0.5f * ramp);
+        default:
+            return ramp;
+        }
+    }
+    switch (shape){
+    case ofxLineShape::STEP:
+        return 0.f;
+    case ofxLineShape::FAST_EXP:
+    case ofxLineShape::SLOW_EXP:
+        return (std::exp(sc * ramp) - 1.0) * norm;
+    case ofxLineShape::FAST_POW:
+    case ofxLineShape::SLOW_POW:
+        return std::pow(ramp, exponent);
+    case ofxLineShape::FAST_COS:
+        return std::sin(omega * ramp);
+    case ofxLineShape::SLOW_COS:
+        return 1.0 - std::cos(omega * ramp);
+    case ofxLineShape::S_CURVE:
+        return 0.5 - 0.5 * std::cos(omega * ramp);
+    default:
+        return ramp;
+    }
+}
+
+void _ofxLineShaper::seed(float ramp){
+    bool fast = ofxControl::isFast();
+    switch (shape){
+    case ofxLineShape::FAST_EXP:
+    case ofxLineShape::SLOW_EXP:
+        x = fast ? ofxControlFastMath::exp(sc * ramp) : std::exp(sc * ramp);
+        break;
+    case ofxLineShape::FAST_COS:
+    case ofxLineShape::SLOW_COS:
+    case ofxLineShape::S_CURVE:
+        if (fast){
+            // omega * ramp / TWO_PI
+            float turns = (shape == ofxLineShape::S_CURVE) ? 0.5f * ramp : 0.25f * ramp;
+            x = ofxControlFastMath::cos2pi(turns);
+            y = ofxControlFastMath::sin2pi(turns);
+        } else {
+            x = std::cos(omega * ramp);
+            y = std::sin(omega * ramp);
+        }
+        break;
+    default:
+        break;
+    }
+    nextRamp = ramp;
+    count = 0;
+    bValid = true;
+}
+
+float _ofxLineShaper::eval(float ramp, float delta){
+    double result;
+    switch (shape){
+    case ofxLineShape::FAST_EXP:
+    case ofxLineShape::SLOW_EXP:
+    case ofxLineShape::FAST_COS:
+    case ofxLineShape::SLOW_COS:
+    case ofxLineShape::S_CURVE:
+        // reseed if we're not where we expected to be (or to get rid of accumulated rounding errors)
+        if (!bValid || count >= renormInterval || std::abs(nextRamp - ramp) > 1e-5){
+            seed(ramp);
+        }
+        // only recompute the step if the increment has changed
+        if (delta != lastDelta){
+            if (shape == ofxLineShape::FAST_EXP || shape == ofxLineShape::SLOW_EXP){
+                stepX = std::exp(sc * delta);
+            } else {
+                stepX = std::cos(omega * delta);
+                stepY = std::sin(omega * delta);
+            }
+            lastDelta = delta;
+        }
+        break;
+    default:
+        return direct(ramp);
+    }
+    // get the current value and advance the state for the next frame
+    if (shape == ofxLineShape::FAST_EXP || shape == ofxLineShape::SLOW_EXP){
+        result = (x - 1.0) * norm;
+        x *= stepX;
+    } else {
+        if (shape == ofxLineShape::FAST_COS){
+            result = y;
+        } else if (shape == ofxLineShape::SLOW_COS){
+            result = 1.0 - x;
+        } else {
+            result = 0.5 - 0.5 * x;
+        }
+        double c = x * stepX - y * stepY;
+        y = y * stepX + x * stepY;
+        x = c;
+    }
+    nextRamp += delta;
+    ++count;
+    return result;
+}
+
 /*--------------------------------------------------------------------*/
 
+// number of steps (max. 'maxSteps') until a ramp position exceeds 'distance', when it advances by 'dt' per step
+static int _ofxLineNumSteps(float distance, float dt, int maxSteps){
+    if (dt <= 0.f){
+        return maxSteps; // never gets there
+    }
+    double n = std::floor((double)distance / dt) + 1.0;
+    return (n < maxSteps) ? std::max(1, (int)n) : maxSteps;
+}
+
+/* the moment the current segment has ended, as offset from the start of the frame: the segment has gone past its end
+ * during the last step of 'step' seconds (ramp time), which is mapped to the current frame of 'frameTime' seconds.
+ * segments which are finished after it (see 'update') have ended later in the same step. */
+template<typename T>
+static float _ofxLineEndOffset(const _ofxLineSegment<T>& segment, float step, float frameTime){
+    if (step <= 0.f){
+        return 0.f;
+    }
+    float overshoot = segment.elapsed - (segment.onset + segment.time);
+    float x = 1.f - overshoot / step;
+    return std::max(0.f, std::min(1.f, x)) * frameTime;
+}
+
+// same for sample 'index' of a block
+template<typename T>
+static float _ofxLineProcessOffset(const _ofxLineSegment<T>& segment, float step, int index, float sampleRate){
+    return std::max(0.f, (index - 1 + _ofxLineEndOffset(segment, step, 1.f)) / sampleRate);
+}
+
 /// ofxLine
 
 ofxLine::ofxLine() {
@@ -61,86 +309,131 @@ ofxLine::~ofxLine() {}
 void ofxLine::init(){
     ofxBaseControl::init();
     value = 0;
-    segmentList.clear();
-    eventList.clear();
+    segmentQueue.clear();
+    eventMap.clear();
+    nextSegmentId = 1; // 0 is reserved, so 'nextSegmentId - 1' never wraps around
     shape = ofxLineShape::LIN;
     coeff = 0;
+    lastStep = 0;
 }
 
 void ofxLine::update(){
-    if (!segmentList.empty() && bRunning){
-        auto segment = segmentList.begin();
-        float ramp = (segment->elapsed - segment->onset) / segment->time;
-        // check if elapsed time has exceeded onset
-        if (ramp > 0.f){
-            // check if ramp time is over
-            if (ramp > 1.0){
-                value = segment->target; // force target value
-                // notify event listeners
-                for (auto& event : segment->eventList){
-                    event->onTimeOut();
+    ofxLine::update((float)timeDomain->getDeltaTime());
+}
+
+void ofxLine::update(float frameTime){
+    if (!segmentQueue.empty() && bRunning){
+        float dt = frameTime * speed;
+        /* finish all segments which have ended since the last update (the left over time is carried into the next segment,
+         * see 'finishSegment'), so the line doesn't fall behind when frames take longer than expected.
+         * segments added by callbacks are only finished on the next update, so they can't keep us here forever. */
+        size_t maxFinished = segmentQueue.size();
+        for (size_t k = 0; k < maxFinished && !segmentQueue.empty(); ++k){
+            ofxLineSegment& segment = segmentQueue.front();
+            if (!(segment.elapsed - segment.onset > segment.time)){
+                break;
+            }
+            finishSegment(_ofxLineEndOffset(segment, lastStep, frameTime));
+        }
+        if (!segmentQueue.empty()){
+            ofxLineSegment& segment = segmentQueue.front();
+            float ramp = (segment.elapsed - segment.onset) / segment.time;
+            // check if elapsed time has exceeded onset (and the segment hasn't been left over by the loop above)
+            if (ramp > 0.f && ramp <= 1.f){
+            // calculate the current value based on ramp position and segment shape
+                float mult = segment.shaper.eval(ramp, dt / segment.time);
+                float diff = segment.target - segment.start;
+                value = segment.start + diff * mult;
+            }
+            // increment elapsed time
+            segment.elapsed += dt;
+            lastStep = dt;
+        }
+    }
+}
+
+void ofxLine::finishSegment(float offset){
+    ofxLineSegment& segment = segmentQueue.front();
+    value = segment.target; // force target value
+    uint64_t id = segment.id;
+    // time which has already passed since the end of the segment
+    float carry = segment.elapsed - segment.onset - segment.time;
+    // notify event listeners
+    fireSegmentEvents(id, offset);
+    // pop segment
+    if (segmentQueue.empty() || segmentQueue.front().id != id){
+       std::cout << "Ooops: a callback function already cleared the segment!\n";
+    } else {
+        segmentQueue.pop_front();
+    }
+    // update the next one (if there is any)
+    if (!segmentQueue.empty()){
+        segmentQueue.front().start = value;
+        segmentQueue.front().elapsed += std::max(0.f, carry);
+    }
+}
+
+void ofxLine::process(float* out, int nframes, float sampleRate){
+    int i = 0;
+    if (bRunning && sampleRate > 0){
+        float dt = (float) speed / sampleRate;
+        // see 'update': max. number of segments to finish at sample 'finishFrame'
+        int finishFrame = -1;
+        size_t maxFinished = 0;
+        while (i < nframes && !segmentQueue.empty()){
+            ofxLineSegment& segment = segmentQueue.front();
+            // same states as in 'update': waiting (pos <= 0), ramping (0 < pos <= time) and finished (pos > time)
+            float pos = segment.elapsed - segment.onset;
+            int remaining = nframes - i;
+            if (pos > segment.time){
+                if (finishFrame != i){
+                    finishFrame = i;
+                    maxFinished = segmentQueue.size();
                 }
-                // pop segment
-                if (segmentList.empty()){
-                   cout << "Ooops: a callback function already cleared the segment!\n";
+                if (maxFinished > 0){
+                    // the next segment continues at the same sample
+                    --maxFinished;
+                    finishSegment(_ofxLineProcessOffset(segment, (i > 0) ? dt : lastStep, i, sampleRate));
                 } else {
-                    segmentList.pop_front();
+                    out[i++] = value;
+                    segment.elapsed += dt;
                 }
-                // update the next one (if there is any)
-                if (!segmentList.empty()){
-                    segmentList.begin()->start = value;
-                }
-                // old segment is now invalid
-                segment = segmentList.end();
+            } else if (pos <= 0.f){
+                int n = (dt > 0.f) ? _ofxLineNumSteps(-pos, dt, remaining) : remaining;
+                std::fill(out + i, out + i + n, value);
+                segment.elapsed += n * dt;
+                i += n;
             } else {
-            // calculate the current value based on ramp position and segment shape
-                float mult;
-                switch (segment->shape){
-                case ofxLineShape::STEP:
-                    mult = 0.0;
-                    break;
-                case ofxLineShape::LIN:
-                    mult = ramp;
-                    break;
-                case ofxLineShape::FAST_EXP:
-                    mult = (segment->coeff <= 0.f) ? ramp
-                        : (exp(ramp * segment->coeff * -1.0) - 1.0) / (exp(segment->coeff * -1.0) - 1.0);
-                    break;
-                case ofxLineShape::FAST_POW:
-                    mult = pow(ramp, 1.0/pow(2.0, segment->coeff));
-                    break;
-                case ofxLineShape::FAST_COS:
-                    mult = sin(ramp * HALF_PI);
-                    break;
-                case ofxLineShape::SLOW_EXP:
-                    mult = (segment->coeff <= 0.f) ? ramp
-                        : (exp(ramp * segment->coeff) - 1.0) / (expf(segment->coeff) - 1.0);
-                    break;
-                case ofxLineShape::SLOW_POW:
-                    mult = pow(ramp, pow(2.0, segment->coeff));
-                    break;
-                case ofxLineShape::SLOW_COS:
-                    mult = cos(ramp * HALF_PI) * -1.0 + 1.0;
-                    break;
-                case ofxLineShape::S_CURVE:
-                    mult = cos(ramp * PI) * -0.5 + 0.5;
-                    break;
-                default:
-                    mult = ramp;
-                    break;
+                // with a negative speed, the line goes back until it is waiting again
+                int n = (dt >= 0.f) ? _ofxLineNumSteps(segment.time - pos, dt, remaining)
+                                    : _ofxLineNumSteps(pos, -dt, remaining);
+                float ramp = pos / segment.time;
+                float delta = dt / segment.time;
+                float start = segment.start;
+                float diff = segment.target - segment.start;
+                float* dst = out + i;
+                if (segment.shape == ofxLineShape::LIN){
+                    // no state, so the compiler can vectorize this
+                    for (int j = 0; j < n; ++j){
+                        dst[j] = start + diff * std::min(1.f, ramp + j * delta);
+                    }
+                } else {
+                    for (int j = 0; j < n; ++j){
+                        dst[j] = start + diff * segment.shaper.eval(std::min(1.f, ramp + j * delta), delta);
+                    }
                 }
-                float diff = segment->target - segment->start;
-				value = segment->start + diff * mult;
+                value = dst[n - 1];
+                segment.elapsed += n * dt;
+                i += n;
             }
         }
-        if (segment != segmentList.end()) {
-            // increment elapsed time
-            segment->elapsed += (float) speed / ofxControl::getFrameRate();
+        if (i > 0){
+            lastStep = dt;
         }
     }
+    std::fill(out + i, out + nframes, value);
 }
 
-
 // get the current value
 float ofxLine::out() const {
     return value;
@@ -148,7 +441,8 @@ float ofxLine::out() const {
 
 // clear all line segments and set value immediatly
 void ofxLine::setValue(float newValue){
-    segmentList.clear();
+    segmentQueue.clear();
+    dropSegmentEvents(nextSegmentId - 1); // keeps the events for the next segment
     value = newValue;
 }
 
@@ -158,54 +452,308 @@ void ofxLine::setShape(ofxLineShape newShape, float newCoeff) {
     coeff = (newCoeff >= 0.f) ? newCoeff : 0.f;
 }
 
-// clear event list
+// remove a single event listener
+bool ofxLine::removeOnSegmentEnd(ofxControlHandle handle){
+    return eventMap.erase(handle);
+}
+
+bool ofxLine::isPending(ofxControlHandle handle) const {
+    return eventMap.contains(handle);
+}
+
+void ofxLine::reserve(int numSegments, int numEvents){
+    segmentQueue.reserve(std::max(0, numSegments));
+    eventMap.reserve(std::max(0, numEvents));
+}
+
+void ofxLine::setFixedCapacity(bool fixed){
+    segmentQueue.setFixedCapacity(fixed);
+}
+
+bool ofxLine::isFixedCapacity() const {
+    return segmentQueue.isFixedCapacity();
+}
+
+// clear event list (only the events which haven't been assigned to a segment yet)
 void ofxLine::clearOnSegmentEnd(){
-    eventList.clear();
+    while (!eventMap.empty() && eventMap.at(eventMap.last()).segment == nextSegmentId){
+        eventMap.eraseAt(eventMap.last());
+    }
+}
+
+// add an event for the next segment (takes ownership of the event)
+ofxControlHandle ofxLine::pushEvent(ofxControlCallback&& callback){
+    _ofxLineEvent e;
+    e.callback = std::move(callback);
+    e.segment = nextSegmentId;
+    return eventMap.insert(std::move(e));
+}
+
+void ofxLine::fireSegmentEvents(uint64_t id, float offset){
+    // events are sorted by segment id. new events added by a callback belong to a later segment, so they stop the loop.
+    while (!eventMap.empty()){
+        uint32_t index = eventMap.first();
+        _ofxLineEvent& e = eventMap.at(index);
+        if (e.segment > id){
+            break;
+        }
+        ofxControlCallback callback = std::move(e.callback);
+        bool fire = (e.segment == id);
+        eventMap.eraseAt(index); // remove *before* calling, the callback might modify the line
+        if (fire){
+            ofxControl::fire(std::move(callback), offset);
+        }
+    }
+}
+
+void ofxLine::dropSegmentEvents(uint64_t id){
+    while (!eventMap.empty() && eventMap.at(eventMap.first()).segment <= id){
+        eventMap.eraseAt(eventMap.first());
+    }
+}
+
+void ofxLine::dropLastSegmentEvents(uint64_t id){
+    // walk backwards over the events of following segments (or pending events)
+    uint32_t index = eventMap.last();
+    while (index != eventMap.npos && eventMap.at(index).segment >= id){
+        uint32_t prev = eventMap.prev(index);
+        if (eventMap.at(index).segment == id){
+            eventMap.eraseAt(index);
+        }
+        index = prev;
+    }
 }
 
 // add a new segment, specifing the target value, the ramp time
 // and a time onset in relation to the end of the last segment
-void ofxLine::addSegment(float targetValue, float rampTime, float timeOnset){
-	ofxLineSegment segment;
+bool ofxLine::addSegment(float targetValue, float rampTime, float timeOnset){
+    // get a new slot in the segment queue
+    ofxLineSegment* segment = segmentQueue.push_back();
+    if (!segment){
+        return false; // queue is full
+    }
 	// initialize segment
-    segment.time = (rampTime >= 0.0) ? rampTime : 0.0;
-    segment.onset = (timeOnset >= 0.0) ? timeOnset : 0.0;
-    segment.start = value; // will be probably overwritten later (if it's not the first segment added)
-    segment.target = targetValue;
-	segment.shape = shape;
-	segment.coeff = coeff;
-    segment.elapsed = 0.0;
-    segment.eventList = std::move(eventList); // eventList is now empty
-    eventList.clear(); // play it safe
-	// finally add to segment list
-    segmentList.push_back(std::move(segment));
+    segment->time = (rampTime >= 0.0) ? rampTime : 0.0;
+    segment->onset = (timeOnset >= 0.0) ? timeOnset : 0.0;
+    segment->start = value; // will be probably overwritten later (if it's not the first segment added)
+    segment->target = targetValue;
+	segment->shape = shape;
+	segment->coeff = coeff;
+    segment->shaper.prepare(shape, coeff);
+    segment->elapsed = 0.0;
+    // (the time axis starts over when the queue has run empty)
+    double last = (segmentQueue.size() > 1) ? segmentQueue[segmentQueue.size() - 2].cumEnd : 0.0;
+    segment->cumEnd = last + segment->onset + segment->time;
+    segment->id = nextSegmentId++; // all pending events now belong to this segment
+    wake();
+    return true;
 }
 
 // pop the last segment from the list
 void ofxLine::removeLastSegment() {
-    if (!segmentList.empty()){
-        segmentList.pop_back();
+    if (!segmentQueue.empty()){
+        dropLastSegmentEvents(segmentQueue.back().id);
+        segmentQueue.pop_back();
         // if we have only one remaining segment, it will be the current one, so we have to initialize the start value
-        if (segmentList.size() == 1){
-            segmentList.begin()->start = value;
+        if (segmentQueue.size() == 1){
+            segmentQueue.front().start = value;
         }
     }
 }
 
 // drop current segment and move to the next
 void ofxLine::nextSegment(){
-    if (!segmentList.empty()){
-        segmentList.pop_front();
-        if (!segmentList.empty()){
-            segmentList.begin()->start = value;
+    if (!segmentQueue.empty()){
+        dropSegmentEvents(segmentQueue.front().id);
+        segmentQueue.pop_front();
+        if (!segmentQueue.empty()){
+            segmentQueue.front().start = value;
         }
     }
 }
 
 // clear all segments
 void ofxLine::clear() {
-    segmentList.clear();
-    eventList.clear();
+    segmentQueue.clear();
+    eventMap.clear();
+}
+
+float ofxLine::valueAt(float t) const {
+    if (segmentQueue.empty()){
+        return value;
+    }
+    double pos = getPosition() + std::max(0.f, t);
+    size_t index = findSegment(pos);
+    if (index == segmentQueue.size()){
+        return segmentQueue.back().target;
+    }
+    return evalSegment(index, pos);
+}
+
+void ofxLine::seek(float t){
+    if (segmentQueue.empty() || !(t > 0.f)){
+        return;
+    }
+    double pos = getPosition() + t;
+    size_t index = findSegment(pos);
+    if (index > 0){
+        // drop the skipped segments (and their events)
+        value = segmentQueue[index - 1].target;
+        dropSegmentEvents(segmentQueue[index - 1].id);
+        for (size_t i = 0; i < index; ++i){
+            segmentQueue.pop_front();
+        }
+    }
+    if (!segmentQueue.empty()){
+        ofxLineSegment& segment = segmentQueue.front();
+        double begin = segment.cumEnd - segment.time - segment.onset;
+        if (index > 0){
+            segment.start = value;
+        }
+        segment.elapsed = pos - begin;
+        value = evalSegment(0, pos);
+    }
+}
+
+float ofxLine::getRemainingTime() const {
+    if (segmentQueue.empty()){
+        return 0.f;
+    }
+    return std::max(0.0, segmentQueue.back().cumEnd - getPosition());
+}
+
+double ofxLine::getPosition() const {
+    const ofxLineSegment& segment = segmentQueue.front();
+    return segment.cumEnd - segment.time - segment.onset + segment.elapsed;
+}
+
+size_t ofxLine::findSegment(double pos) const {
+    // first segment which ends at or after 'pos'
+    size_t lo = 0;
+    size_t hi = segmentQueue.size();
+    while (lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if (segmentQueue[mid].cumEnd < pos){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+float ofxLine::evalSegment(size_t index, double pos) const {
+    const ofxLineSegment& segment = segmentQueue[index];
+    // the start value of the following segments is only set when they become the current segment
+    float start = (index > 0) ? segmentQueue[index - 1].target : segment.start;
+    double ramp = pos - (segment.cumEnd - segment.time);
+    if (ramp <= 0.0){
+        return start; // waiting for the onset
+    } else if (ramp >= segment.time){
+        return segment.target;
+    } else {
+        return start + (segment.target - start) * segment.shaper.direct(ramp / segment.time);
+    }
+}
+
+ofxControlStateType ofxLine::getStateType() const {
+    return ofxControlStateType::LINE;
+}
+
+// size of a saved ofxLineSegment
+static const size_t lineSegmentSize = 6 * sizeof(float) + sizeof(ofxLineShape) + sizeof(double) + sizeof(uint64_t);
+
+void ofxLine::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseControl::saveState(writer);
+    writer.write(value);
+    writer.write(shape);
+    writer.write(coeff);
+    writer.write(lastStep);
+    writer.write(nextSegmentId);
+    writer.write((uint32_t)segmentQueue.size());
+    for (size_t i = 0; i < segmentQueue.size(); ++i){
+        const ofxLineSegment& segment = segmentQueue[i];
+        writer.write(segment.time);
+        writer.write(segment.onset);
+        writer.write(segment.start);
+        writer.write(segment.target);
+        writer.write(segment.shape);
+        writer.write(segment.coeff);
+        writer.write(segment.elapsed);
+        writer.write(segment.cumEnd);
+        writer.write(segment.id);
+    }
+    saveEvents(writer);
+}
+
+bool ofxLine::restoreState(ofxControlStateReader& reader){
+    if (!ofxBaseControl::restoreState(reader)){
+        return false;
+    }
+    float newValue, newCoeff, newStep;
+    ofxLineShape newShape;
+    uint64_t newSegmentId;
+    uint32_t numSegments;
+    if (!reader.read(newValue) || !reader.read(newShape) || !reader.read(newCoeff) || !reader.read(newStep)
+            || !reader.read(newSegmentId) || !reader.readCount(numSegments, lineSegmentSize)){
+        return false;
+    }
+    if (segmentQueue.isFixedCapacity() && numSegments > segmentQueue.capacity()){
+        return false;
+    }
+    // read all segments first, so the line stays intact if the data is invalid
+    std::vector<ofxLineSegment> segments(numSegments);
+    for (auto& segment : segments){
+        if (!reader.read(segment.time) || !reader.read(segment.onset) || !reader.read(segment.start)
+                || !reader.read(segment.target) || !reader.read(segment.shape) || !reader.read(segment.coeff)
+                || !reader.read(segment.elapsed) || !reader.read(segment.cumEnd) || !reader.read(segment.id)){
+            return false;
+        }
+        segment.shaper.prepare(segment.shape, segment.coeff);
+    }
+    value = newValue;
+    shape = newShape;
+    coeff = newCoeff;
+    lastStep = newStep;
+    nextSegmentId = newSegmentId;
+    segmentQueue.clear();
+    for (auto& segment : segments){
+        segmentQueue.push_back(segment);
+    }
+    return restoreEvents(reader);
+}
+
+void ofxLine::saveEvents(ofxControlStateWriter& writer) const {
+    size_t countPos = writer.reserveCount();
+    uint32_t count = 0;
+    for (uint32_t index = eventMap.first(); index != eventMap.npos; index = eventMap.next(index)){
+        uint64_t id;
+        if (writer.writeEvent(eventMap.handle(index), id)){
+            writer.write(eventMap.at(index).segment);
+            ++count;
+        }
+    }
+    writer.writeCount(countPos, count);
+}
+
+bool ofxLine::restoreEvents(ofxControlStateReader& reader){
+    uint32_t numEvents;
+    if (!reader.readCount(numEvents, 2 * sizeof(uint64_t))){
+        return false;
+    }
+    eventMap.clear();
+    // the events have been saved in order, so the map stays sorted by segment id
+    for (uint32_t i = 0; i < numEvents; ++i){
+        uint64_t id;
+        _ofxLineEvent e;
+        if (!reader.readEvent(id, e.callback) || !reader.read(e.segment)){
+            return false;
+        }
+        if (e.callback){
+            reader.restored(id, eventMap.insert(std::move(e)));
+        }
+    }
+    return true;
 }
 
 
@@ -230,85 +778,133 @@ ofxMultiLine::~ofxMultiLine() {}
 void ofxMultiLine::init(){
     ofxBaseControl::init();
     valueVec = {0};
-    multiSegmentList.clear();
-    eventList.clear();
+    multiSegmentQueue.clear();
+    eventMap.clear();
+    nextSegmentId = 1; // 0 is reserved, so 'nextSegmentId - 1' never wraps around
     shape = ofxLineShape::LIN;
     coeff = 0;
+    lastStep = 0;
 }
 
 void ofxMultiLine::update(){
-    if (!multiSegmentList.empty() && bRunning){
-        auto segment = multiSegmentList.begin();
-        float ramp = (segment->elapsed - segment->onset) / segment->time;
-        // check if elapsed time has exceeded onset
-        if (ramp > 0.f){
-            // check if ramp time is over
-            if (ramp > 1.0){
-                valueVec = std::move(segment->target); // force target value
-                // notify event listeners
-                for (auto& event : segment->eventList){
-                    event->onTimeOut();
+    ofxMultiLine::update((float)timeDomain->getDeltaTime());
+}
+
+void ofxMultiLine::update(float frameTime){
+    if (!multiSegmentQueue.empty() && bRunning){
+        float dt = frameTime * speed;
+        /* finish all segments which have ended since the last update (the left over time is carried into the next segment,
+         * see 'finishSegment'), so the line doesn't fall behind when frames take longer than expected.
+         * segments added by callbacks are only finished on the next update, so they can't keep us here forever. */
+        size_t maxFinished = multiSegmentQueue.size();
+        for (size_t k = 0; k < maxFinished && !multiSegmentQueue.empty(); ++k){
+            ofxMultiLineSegment& segment = multiSegmentQueue.front();
+            if (!(segment.elapsed - segment.onset > segment.time)){
+                break;
+            }
+            finishSegment(_ofxLineEndOffset(segment, lastStep, frameTime));
+        }
+        if (!multiSegmentQueue.empty()){
+            ofxMultiLineSegment& segment = multiSegmentQueue.front();
+            float ramp = (segment.elapsed - segment.onset) / segment.time;
+            // check if elapsed time has exceeded onset (and the segment hasn't been left over by the loop above)
+            if (ramp > 0.f && ramp <= 1.f){
+            // calculate the current value based on ramp position and segment shape
+                float mult = segment.shaper.eval(ramp, dt / segment.time);
+                // vectorized: valueVec[i] = start[i] + (target[i] - start[i]) * mult
+                ofxControlSimd::lerp(valueVec.data(), segment.start.data(), segment.target.data(), mult, valueVec.size());
+            }
+            // increment elapsed time
+            segment.elapsed += dt;
+            lastStep = dt;
+        }
+    }
+}
+
+void ofxMultiLine::finishSegment(float offset){
+    ofxMultiLineSegment& segment = multiSegmentQueue.front();
+    valueVec.swap(segment.target); // force target value (swap, so the segment slot keeps its memory)
+    uint64_t id = segment.id;
+    // time which has already passed since the end of the segment
+    float carry = segment.elapsed - segment.onset - segment.time;
+    // notify event listeners
+    fireSegmentEvents(id, offset);
+    // pop segment
+    if (multiSegmentQueue.empty() || multiSegmentQueue.front().id != id){
+       std::cout << "Ooops: a callback function already cleared the segment!\n";
+    } else {
+        multiSegmentQueue.pop_front();
+    }
+    // update the next one (if there is any)
+    if (!multiSegmentQueue.empty()){
+        multiSegmentQueue.front().start = valueVec;
+        multiSegmentQueue.front().elapsed += std::max(0.f, carry);
+    }
+}
+
+void ofxMultiLine::process(float* out, int nframes, float sampleRate){
+    // the layout of the block is fixed, even if a callback changes the number of lines
+    const size_t numLines = valueVec.size();
+    auto writeFrame = [&](float* dst){
+        size_t n = std::min(numLines, valueVec.size());
+        std::copy(valueVec.begin(), valueVec.begin() + n, dst);
+        std::fill(dst + n, dst + numLines, 0.f);
+    };
+    int i = 0;
+    if (bRunning && sampleRate > 0){
+        float dt = (float) speed / sampleRate;
+        int finishFrame = -1;
+        size_t maxFinished = 0;
+        while (i < nframes && !multiSegmentQueue.empty()){
+            ofxMultiLineSegment& segment = multiSegmentQueue.front();
+            // see ofxLine::process
+            float pos = segment.elapsed - segment.onset;
+            int remaining = nframes - i;
+            if (pos > segment.time){
+                if (finishFrame != i){
+                    finishFrame = i;
+                    maxFinished = multiSegmentQueue.size();
                 }
-                // pop segment
-                if (multiSegmentList.empty()){
-                   cout << "Ooops: a callback function already cleared the segment!\n";
+                if (maxFinished > 0){
+                    --maxFinished;
+                    finishSegment(_ofxLineProcessOffset(segment, (i > 0) ? dt : lastStep, i, sampleRate));
                 } else {
-                    multiSegmentList.pop_front();
+                    writeFrame(out + i * numLines);
+                    ++i;
+                    segment.elapsed += dt;
                 }
-                // update the next one (if there is any)
-                if (!multiSegmentList.empty()){
-                    multiSegmentList.begin()->start = valueVec;
+            } else if (pos <= 0.f){
+                int n = (dt > 0.f) ? _ofxLineNumSteps(-pos, dt, remaining) : remaining;
+                for (int j = 0; j < n; ++j){
+                    writeFrame(out + (i + j) * numLines);
                 }
-                // old segment is now invalid
-                segment = multiSegmentList.end();
+                segment.elapsed += n * dt;
+                i += n;
+            } else if (valueVec.size() != numLines){
+                // the number of lines has changed in the middle of the block, just keep the values
+                writeFrame(out + i * numLines);
+                ++i;
             } else {
-            // calculate the current value based on ramp position and segment shape
-                float mult;
-                switch (segment->shape){
-                case ofxLineShape::STEP:
-                    mult = 0.0;
-                    break;
-                case ofxLineShape::LIN:
-                    mult = ramp;
-                    break;
-                case ofxLineShape::FAST_EXP:
-                    mult = (segment->coeff <= 0.f) ? ramp
-                        : (exp(ramp * segment->coeff * -1.0) - 1.0) / (exp(segment->coeff * -1.0) - 1.0);
-                    break;
-                case ofxLineShape::FAST_POW:
-                    mult = pow(ramp, 1.0/pow(2.0, segment->coeff));
-                    break;
-                case ofxLineShape::FAST_COS:
-                    mult = sin(ramp * HALF_PI);
-                    break;
-                case ofxLineShape::SLOW_EXP:
-                    mult = (segment->coeff <= 0.f) ? ramp
-                        : (exp(ramp * segment->coeff) - 1.0) / (expf(segment->coeff) - 1.0);
-                    break;
-                case ofxLineShape::SLOW_POW:
-                    mult = pow(ramp, pow(2.0, segment->coeff));
-                    break;
-                case ofxLineShape::SLOW_COS:
-                    mult = cos(ramp * HALF_PI) * -1.0 + 1.0;
-                    break;
-                case ofxLineShape::S_CURVE:
-                    mult = cos(ramp * PI) * -0.5 + 0.5;
-                    break;
-                default:
-                    mult = ramp;
-                    break;
+                int n = (dt >= 0.f) ? _ofxLineNumSteps(segment.time - pos, dt, remaining)
+                                    : _ofxLineNumSteps(pos, -dt, remaining);
+                float ramp = pos / segment.time;
+                float delta = dt / segment.time;
+                for (int j = 0; j < n; ++j){
+                    float mult = segment.shaper.eval(std::min(1.f, ramp + j * delta), delta);
+                    ofxControlSimd::lerp(out + (i + j) * numLines, segment.start.data(), segment.target.data(), mult, numLines);
                 }
-                for (int i = 0; i < valueVec.size(); ++i){
-					float diff = segment->target[i] - segment->start[i];
-                    valueVec[i] = segment->start[i] + diff * mult;
-				}
+                std::copy(out + (i + n - 1) * numLines, out + (i + n) * numLines, valueVec.begin());
+                segment.elapsed += n * dt;
+                i += n;
             }
         }
-        if (segment != multiSegmentList.end()) {
-            // increment elapsed time
-            segment->elapsed += (float) speed / ofxControl::getFrameRate();
+        if (i > 0){
+            lastStep = dt;
         }
     }
+    for (; i < nframes; ++i){
+        writeFrame(out + i * numLines);
+    }
 }
 
 // set number of lines
@@ -316,9 +912,9 @@ void ofxMultiLine::setNumLines(int numLines){
 	numLines = std::max(1, numLines);
     valueVec.resize(numLines, 0);
 	// resize stored segments
-    for (auto& segment : multiSegmentList){
-        segment.start.resize(numLines, 0);
-        segment.target.resize(numLines, 0);
+    for (size_t i = 0; i < multiSegmentQueue.size(); ++i){
+        multiSegmentQueue[i].start.resize(numLines, 0);
+        multiSegmentQueue[i].target.resize(numLines, 0);
     }
 }
 
@@ -334,66 +930,192 @@ float ofxMultiLine::operator[](int index) const{
 
 
 // get the current values
-vector<float> ofxMultiLine::out() const {
-    return valueVec;
+std::vector<float> ofxMultiLine::out() const {
+    return std::vector<float>(valueVec.begin(), valueVec.end());
+}
+
+ofxControlFloatView ofxMultiLine::values() const {
+    return ofxControlFloatView(valueVec.data(), valueVec.size());
+}
+
+const float* ofxMultiLine::data() const {
+    return valueVec.data();
+}
+
+void ofxMultiLine::copyTo(float* dst) const {
+    std::copy(valueVec.begin(), valueVec.end(), dst);
+}
+
+int ofxMultiLine::copyTo(float* dst, int maxCount) const {
+    int n = std::max(0, std::min(maxCount, (int)valueVec.size()));
+    std::copy(valueVec.begin(), valueVec.begin() + n, dst);
+    return n;
 }
 
 // clear all line segments and set values immediatly
-void ofxMultiLine::setValues(const vector<float>& newValues){
-    multiSegmentList.clear();
-    valueVec = newValues;
+void ofxMultiLine::setValues(const std::vector<float>& newValues){
+    multiSegmentQueue.clear();
+    dropSegmentEvents(nextSegmentId - 1);
+    valueVec.assign(newValues.begin(), newValues.end());
 }
 
 void ofxMultiLine::setValues(float newValue){
-    multiSegmentList.clear();
+    multiSegmentQueue.clear();
+    dropSegmentEvents(nextSegmentId - 1);
     valueVec.assign(valueVec.size(), newValue);
 }
 
 // add a new segment, specifing the target value, the ramp time
 // and a time onset in relation to the end of the last segment
-void ofxMultiLine::addSegment(const vector<float> & targetValues, float rampTime, float timeOnset){
-	// make new segment
-    ofxMultiLineSegment segment;
-    segment.time = (rampTime >= 0.0) ? rampTime : 0.0;
-    segment.onset = (timeOnset >= 0.0) ? timeOnset : 0.0;
-    segment.start = valueVec; // will probably be overwritten later (if it's not the first segment added)
-    segment.target = targetValues;
-    segment.target.resize(valueVec.size(), 0); // make sure that target vector has the right dimension
-	segment.shape = shape;
-	segment.coeff = coeff;
-    segment.elapsed = 0.0;
-    segment.eventList = std::move(eventList); // eventList is now empty
-    eventList.clear(); // play it safe
-	// finally add to segment list
-    multiSegmentList.push_back(std::move(segment));
+bool ofxMultiLine::addSegment(const std::vector<float> & targetValues, float rampTime, float timeOnset){
+    // get a new slot in the segment queue
+    ofxMultiLineSegment* segment = multiSegmentQueue.push_back();
+    if (!segment){
+        return false; // queue is full
+    }
+    segment->time = (rampTime >= 0.0) ? rampTime : 0.0;
+    segment->onset = (timeOnset >= 0.0) ? timeOnset : 0.0;
+    // assign (instead of copy constructing) so the vectors of a reused slot don't reallocate
+    segment->start.assign(valueVec.begin(), valueVec.end()); // will probably be overwritten later (if it's not the first segment added)
+    size_t n = std::min(targetValues.size(), valueVec.size());
+    segment->target.assign(targetValues.begin(), targetValues.begin() + n);
+    segment->target.resize(valueVec.size(), 0); // make sure that target vector has the right dimension
+	segment->shape = shape;
+	segment->coeff = coeff;
+    segment->shaper.prepare(shape, coeff);
+    segment->elapsed = 0.0;
+    segment->id = nextSegmentId++; // all pending events now belong to this segment
+    wake();
+    return true;
 }
 
 // pop the last segment from the list
 void ofxMultiLine::removeLastSegment() {
-    if (!multiSegmentList.empty()){
-        multiSegmentList.pop_back();
+    if (!multiSegmentQueue.empty()){
+        dropLastSegmentEvents(multiSegmentQueue.back().id);
+        multiSegmentQueue.pop_back();
         // if we have only one remaining segment, it will be the current one, so we have to update the start value
-        if (multiSegmentList.size() == 1){
-            multiSegmentList.begin()->start = valueVec;
+        if (multiSegmentQueue.size() == 1){
+            multiSegmentQueue.front().start = valueVec;
         }
     }
 }
 
 // drop current segment and move to the next
 void ofxMultiLine::nextSegment(){
-    if (!multiSegmentList.empty()){
-        multiSegmentList.pop_front();
-        if (!multiSegmentList.empty()){
+    if (!multiSegmentQueue.empty()){
+        dropSegmentEvents(multiSegmentQueue.front().id);
+        multiSegmentQueue.pop_front();
+        if (!multiSegmentQueue.empty()){
 			// update the start values for the now current segment
-            multiSegmentList.begin()->start = valueVec;
+            multiSegmentQueue.front().start = valueVec;
         }
     }
 }
 
 // clear all segments
 void ofxMultiLine::clear() {
-    multiSegmentList.clear();
-    eventList.clear();
+    multiSegmentQueue.clear();
+    eventMap.clear();
+}
+
+void ofxMultiLine::reserve(int numSegments, int numEvents){
+    numSegments = std::max(0, numSegments);
+    multiSegmentQueue.reserve(numSegments);
+    eventMap.reserve(std::max(0, numEvents));
+    // prime the unused slots with value vectors of the right size (popped slots keep their memory)
+    size_t used = multiSegmentQueue.size();
+    size_t numLines = valueVec.size();
+    while (multiSegmentQueue.size() < multiSegmentQueue.capacity()){
+        ofxMultiLineSegment* segment = multiSegmentQueue.push_back();
+        segment->start.reserve(numLines);
+        segment->target.reserve(numLines);
+    }
+    while (multiSegmentQueue.size() > used){
+        multiSegmentQueue.pop_back();
+    }
+}
+
+void ofxMultiLine::setFixedCapacity(bool fixed){
+    multiSegmentQueue.setFixedCapacity(fixed);
+}
+
+bool ofxMultiLine::isFixedCapacity() const {
+    return multiSegmentQueue.isFixedCapacity();
+}
+
+ofxControlStateType ofxMultiLine::getStateType() const {
+    return ofxControlStateType::MULTI_LINE;
+}
+
+void ofxMultiLine::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseControl::saveState(writer);
+    uint32_t numLines = valueVec.size();
+    writer.write(shape);
+    writer.write(coeff);
+    writer.write(lastStep);
+    writer.write(nextSegmentId);
+    writer.write(numLines);
+    writer.write(valueVec.data(), numLines * sizeof(float));
+    writer.write((uint32_t)multiSegmentQueue.size());
+    for (size_t i = 0; i < multiSegmentQueue.size(); ++i){
+        const ofxMultiLineSegment& segment = multiSegmentQueue[i];
+        writer.write(segment.time);
+        writer.write(segment.onset);
+        writer.write(segment.shape);
+        writer.write(segment.coeff);
+        writer.write(segment.elapsed);
+        writer.write(segment.id);
+        // (the vectors always have the size of 'valueVec')
+        writer.write(segment.start.data(), numLines * sizeof(float));
+        writer.write(segment.target.data(), numLines * sizeof(float));
+    }
+    saveEvents(writer);
+}
+
+bool ofxMultiLine::restoreState(ofxControlStateReader& reader){
+    if (!ofxBaseControl::restoreState(reader)){
+        return false;
+    }
+    float newCoeff, newStep;
+    ofxLineShape newShape;
+    uint64_t newSegmentId;
+    uint32_t numLines, numSegments;
+    if (!reader.read(newShape) || !reader.read(newCoeff) || !reader.read(newStep) || !reader.read(newSegmentId)
+            || !reader.readCount(numLines, sizeof(float)) || numLines == 0){
+        return false;
+    }
+    ofxControlAlignedVector<float> newValues(numLines);
+    size_t segmentSize = 4 * sizeof(float) + sizeof(ofxLineShape) + sizeof(uint64_t) + 2 * numLines * sizeof(float);
+    if (!reader.read(newValues.data(), numLines * sizeof(float)) || !reader.readCount(numSegments, segmentSize)){
+        return false;
+    }
+    if (multiSegmentQueue.isFixedCapacity() && numSegments > multiSegmentQueue.capacity()){
+        return false;
+    }
+    // read all segments first, so the line stays intact if the data is invalid
+    std::vector<ofxMultiLineSegment> segments(numSegments);
+    for (auto& segment : segments){
+        segment.start.resize(numLines);
+        segment.target.resize(numLines);
+        if (!reader.read(segment.time) || !reader.read(segment.onset) || !reader.read(segment.shape)
+                || !reader.read(segment.coeff) || !reader.read(segment.elapsed) || !reader.read(segment.id)
+                || !reader.read(segment.start.data(), numLines * sizeof(float))
+                || !reader.read(segment.target.data(), numLines * sizeof(float))){
+            return false;
+        }
+        segment.shaper.prepare(segment.shape, segment.coeff);
+    }
+    shape = newShape;
+    coeff = newCoeff;
+    lastStep = newStep;
+    nextSegmentId = newSegmentId;
+    valueVec.swap(newValues);
+    multiSegmentQueue.clear();
+    for (auto& segment : segments){
+        multiSegmentQueue.push_back(std::move(segment));
+    }
+    return restoreEvents(reader);
 }
 
 
@@ -413,20 +1135,62 @@ ofxClock::~ofxClock() {
 
 void ofxClock::init(){
     ofxBaseControl::init();
-    clockList.clear();
+    clockMap.clear();
+    clockHeap.clear();
+    clockTime = 0.0;
+    clockOrder = 0;
+    cues.reset();
 }
-// walk through the clock list and check for timeouts
+
+// heap ordering: earlier deadlines first, clocks with the same deadline in the order they were added
+static bool clockIsLater(const _ofxClockEntry& a, const _ofxClockEntry& b){
+    return (a.deadline > b.deadline) || (a.deadline == b.deadline && a.order > b.order);
+}
+
+// advance the clock time and fire all clocks which have timed out.
+// only the due clocks are touched, so the cost per frame is O(fired * log n)
 void ofxClock::update(){
+    advance(timeDomain->getDeltaTime());
+}
+
+void ofxClock::update(float dt){
+    advance(dt);
+}
+
+void ofxClock::advance(double dt){
     if (bRunning){
-        auto clock = clockList.begin();
-        while (clock != clockList.end()){
-            // increment elapsed time
-            (*clock)->elapsed += (float) speed / ofxControl::getFrameRate();
-            if ((*clock)->elapsed > (*clock)->delay){
-                (*clock)->onTimeOut();
-                clock = clockList.erase(clock);
-            } else {
-                ++clock;
+        double start = clockTime;
+        clockTime += speed * dt;
+        while (true){
+            // cues and clocks fire in the order of their deadlines
+            if (cues && cues->next < cues->count){
+                ofxClockCue cue = cues->list->getCue(cues->next);
+                double deadline = cues->start + cue.time;
+                if (deadline < clockTime && (clockHeap.empty() || deadline <= clockHeap.front().deadline)){
+                    float offset = (speed > 0) ? std::max(0.0, (deadline - start) / speed) : 0.f;
+                    cues->next++;
+                    if (auto callback = cues->callback){
+                        ofxControl::fire(ofxControlCallback([callback, cue](float offset){
+                            (*callback)(cue, offset);
+                        }), offset);
+                    }
+                    continue;
+                }
+            }
+            if (clockHeap.empty() || clockHeap.front().deadline >= clockTime){
+                break;
+            }
+            // clocks which are already overdue (e.g. added with zero delay by a callback) fire at the start
+            float offset = (speed > 0) ? std::max(0.0, (clockHeap.front().deadline - start) / speed) : 0.f;
+            std::pop_heap(clockHeap.begin(), clockHeap.end(), clockIsLater);
+            ofxControlHandle handle = clockHeap.back().handle;
+            clockHeap.pop_back();
+            // skip cancelled clocks
+            if (auto callback = clockMap.get(handle)){
+                // take the event out *before* calling it, so the callback can safely add or cancel clocks
+                ofxControlCallback func = std::move(*callback);
+                clockMap.erase(handle);
+                ofxControl::fire(std::move(func), offset);
             }
         }
     }
@@ -434,28 +1198,168 @@ void ofxClock::update(){
 
 /* template definitions for 'add' and 'cancel' functions are in header file */
 
+// schedule an event at an absolute deadline
+ofxControlHandle ofxClock::push(float delayTime, ofxControlCallback&& callback){
+    delayTime = (delayTime >= 0.0) ? delayTime : 0.0;
+    _ofxClockEntry entry;
+    entry.deadline = clockTime + delayTime;
+    entry.order = clockOrder++;
+    entry.handle = clockMap.insert(std::move(callback));
+    clockHeap.push_back(entry);
+    std::push_heap(clockHeap.begin(), clockHeap.end(), clockIsLater);
+    wake();
+    return entry.handle;
+}
+
+// cancle a single clock
+bool ofxClock::cancel(ofxControlHandle handle){
+    if (clockMap.erase(handle)){
+        purgeHeap();
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool ofxClock::isPending(ofxControlHandle handle) const {
+    return clockMap.contains(handle);
+}
+
 // cancle the first added clock
 void ofxClock::cancelFirst(){
-	if (!clockList.empty()) {clockList.pop_front();}
+    if (!clockMap.empty()) {
+        clockMap.eraseAt(clockMap.first());
+        purgeHeap();
+    }
 }
 // cancle the last added clock
 void ofxClock::cancelLast(){
-	if (!clockList.empty()) {clockList.pop_back();}
+    if (!clockMap.empty()) {
+        clockMap.eraseAt(clockMap.last());
+        purgeHeap();
+    }
 }
 // delete all clocks
 void ofxClock::clear(){
-	if (!clockList.empty()) {clockList.clear();}
+    clockMap.clear();
+	clockHeap.clear();
 }
 
-void ofxClock::searchAndRemove(ofxControlBaseEvent* testobj){
-    auto clock = clockList.begin();
-    while (clock != clockList.end()){
-        if ((*clock)->compare(testobj)){
-            clock = clockList.erase(clock);
-        } else {
-            ++clock;
+int ofxClock::getNumPending() const {
+    return clockMap.size();
+}
+
+void ofxClock::reserve(int numClocks){
+    numClocks = std::max(0, numClocks);
+    clockMap.reserve(numClocks);
+    clockHeap.reserve(2 * numClocks + 64); // room for stale entries (see 'purgeHeap')
+}
+
+void ofxClock::setCues(ofxClockCueListPtr list, ofxClockCueCallback callback, double startTime){
+    if (list){
+        auto& c = cues.emplace();
+        startTime = std::max(0.0, startTime);
+        c.list = std::move(list);
+        c.callback = callback ? std::make_shared<ofxClockCueCallback>(std::move(callback)) : nullptr;
+        // the cue at 'startTime' is due right now
+        c.start = clockTime - startTime;
+        c.next = c.list->findCue(startTime);
+        c.count = c.list->getNumCues();
+        wake();
+    } else {
+        cues.reset();
+    }
+}
+
+const ofxClockCueListPtr& ofxClock::getCues() const {
+    static const ofxClockCueListPtr none;
+    return cues ? cues->list : none;
+}
+
+void ofxClock::searchAndRemove(const ofxControlCallback& test){
+    uint32_t index = clockMap.first();
+    while (index != clockMap.npos){
+        uint32_t next = clockMap.next(index);
+        if (clockMap.at(index).matches(test)){
+            clockMap.eraseAt(index);
+        }
+        index = next;
+    }
+    purgeHeap();
+}
+
+// cancelled clocks stay in the heap until their deadline comes up.
+// only rebuild the heap if the stale entries start to dominate (amortized O(1) per cancel)
+void ofxClock::purgeHeap(){
+    if (clockHeap.size() > 2 * clockMap.size() + 64){
+        auto end = std::remove_if(clockHeap.begin(), clockHeap.end(),
+            [&](const _ofxClockEntry& entry){ return !clockMap.contains(entry.handle); });
+        clockHeap.erase(end, clockHeap.end());
+        std::make_heap(clockHeap.begin(), clockHeap.end(), clockIsLater);
+    }
+}
+
+ofxControlStateType ofxClock::getStateType() const {
+    return ofxControlStateType::CLOCK;
+}
+
+void ofxClock::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseControl::saveState(writer);
+    writer.write(clockTime);
+    writer.write(clockOrder);
+    // pending clocks in the order they have been added (skip cancelled clocks)
+    std::vector<_ofxClockEntry> entries;
+    entries.reserve(clockMap.size());
+    for (auto& entry : clockHeap){
+        if (clockMap.contains(entry.handle)){
+            entries.push_back(entry);
         }
     }
+    std::sort(entries.begin(), entries.end(),
+        [](const _ofxClockEntry& a, const _ofxClockEntry& b){ return a.order < b.order; });
+    size_t countPos = writer.reserveCount();
+    uint32_t count = 0;
+    for (auto& entry : entries){
+        uint64_t id;
+        if (writer.writeEvent(entry.handle, id)){
+            writer.write(entry.deadline);
+            writer.write(entry.order);
+            ++count;
+        }
+    }
+    writer.writeCount(countPos, count);
+}
+
+bool ofxClock::restoreState(ofxControlStateReader& reader){
+    if (!ofxBaseControl::restoreState(reader)){
+        return false;
+    }
+    double newTime;
+    uint64_t newOrder;
+    uint32_t numClocks;
+    if (!reader.read(newTime) || !reader.read(newOrder)
+            || !reader.readCount(numClocks, sizeof(uint64_t) + sizeof(double) + sizeof(uint64_t))){
+        return false;
+    }
+    clear();
+    cues.reset();
+    clockTime = newTime;
+    clockOrder = newOrder;
+    for (uint32_t i = 0; i < numClocks; ++i){
+        uint64_t id;
+        ofxControlCallback callback;
+        _ofxClockEntry entry;
+        if (!reader.readEvent(id, callback) || !reader.read(entry.deadline) || !reader.read(entry.order)){
+            return false;
+        }
+        if (callback){
+            entry.handle = clockMap.insert(std::move(callback));
+            clockHeap.push_back(entry);
+            std::push_heap(clockHeap.begin(), clockHeap.end(), clockIsLater);
+            reader.restored(id, entry.handle);
+        }
+    }
+    return true;
 }
 
 
@@ -479,38 +1383,206 @@ void ofxBaseOsc::init(){
     offset = 0.0;
     counter = 0;
     bReset = true;
-    eventList.clear();
+    eventMap.clear();
+    phaseMode = ofxOscPhaseMode::FLOAT;
+    fixedPhase = 0;
+    wraps = 0;
+    lastInc = 0;
+    updateIncrement(timeDomain->getDeltaTime());
 }
 
 void ofxBaseOsc::update(){
+    advance(timeDomain->getDeltaTime());
+}
+
+void ofxBaseOsc::update(float dt){
+    advance(dt);
+}
+
+void ofxBaseOsc::advance(double dt){
     if (bRunning){
-        float old = wrapped;
-        if (offset != 0.0){
-            wrapped = fmod(phase + offset, 1.0);
-            if (wrapped < 0.0){
-                wrapped += 1.0;
-            }
+        if (phaseMode == ofxOscPhaseMode::FIXED){
+            updateFixed(dt);
         } else {
-            wrapped = phase;
+            updateFloat(dt);
         }
+    }
+}
 
-        if (!bReset){
-            if ((freq > 0.0 && (wrapped - old) <= 0.0) ||
-                (freq < 0.0 && (old - wrapped) <= 0.0)){
-                for (auto & event : eventList){
-                    event->onTimeOut();
-                }
-                ++counter;
-            }
+void ofxBaseOsc::updateFloat(double dt){
+    float old = wrapped;
+    if (offset != 0.0){
+        wrapped = std::fmod(phase + offset, 1.0);
+        if (wrapped < 0.0){
+            wrapped += 1.0;
         }
+    } else {
+        wrapped = phase;
+    }
+
+    if (!bReset && wraps != 0){
+        firePeriods(std::abs(wraps), wraps > 0, old, wrapped, lastInc, dt, 0);
+    }
 
+    bReset = false;
+    lastInc = speed * freq * dt;
+    double next = phase + lastInc + std::numeric_limits<float>::epsilon(); // add a very little offset to compensate for precision errors.
+    // count the period boundaries crossed by the unwrapped phase (including the offset), so steps of whole periods are not lost
+    wraps = (int64_t)(std::floor(next + offset) - std::floor(phase + offset));
+    phase = std::fmod(next, 1.0);
+    if (phase < 0.0){
+        phase += 1.0;
+    }
+}
+
+void ofxBaseOsc::updateFixed(double dt){
+    if (freq != incFreq || speed != incSpeed || dt != incDt){
+        updateIncrement(dt);
+    }
+    float old = wrapped;
+    wrapped = fromFixed(fixedPhase);
+
+    // (the number of periods is exact, even for frequencies above the update rate)
+    if (wraps != 0){
+        firePeriods(std::abs(wraps), wraps > 0, old, wrapped, lastInc, dt, 0);
+    }
+
+    lastInc = speed * freq * dt;
+    // the carry of the fractional part tells if we have crossed a period boundary
+    uint64_t next = fixedPhase + fixedInc;
+    wraps = fixedPeriods + (next < fixedPhase);
+    fixedPhase = next;
+}
+
+void ofxBaseOsc::updateIncrement(double dt){
+    incFreq = freq;
+    incSpeed = speed;
+    incDt = dt;
+    splitIncrement((double)incSpeed * incFreq * incDt, fixedPeriods, fixedInc);
+}
+
+// split a phase increment into whole periods and a 0.64 fixed point fraction
+void ofxBaseOsc::splitIncrement(double inc, int64_t& periods, uint64_t& fraction){
+    double whole = std::floor(inc);
+    double f = inc - whole;
+    if (f >= 1.0){
+        // tiny negative increments can round up
+        whole += 1.0;
+        f = 0.0;
+    }
+    periods = (int64_t)whole;
+    fraction = (uint64_t)(f * 18446744073709551616.0); // 2^64
+}
+
+void ofxBaseOsc::process(float* out, int nframes, float sampleRate){
+    if (nframes <= 0){
+        return;
+    }
+    if (!bRunning || sampleRate <= 0){
+        // the phase doesn't move, so the output is constant
+        std::fill(out, out + nframes, this->out());
+        return;
+    }
+    if (phaseMode == ofxOscPhaseMode::FIXED){
+        int64_t periods;
+        uint64_t inc;
+        splitIncrement((double)speed * freq / sampleRate, periods, inc);
+        double sampleInc = (double)speed * freq / sampleRate;
+        float old = wrapped;
+        for (int i = 0; i < nframes; ++i){
+            out[i] = fromFixed(fixedPhase);
+            if (wraps != 0){
+                firePeriods(std::abs(wraps), wraps > 0, old, out[i], lastInc, 1.0 / sampleRate, (i - 1) / sampleRate);
+            }
+            uint64_t next = fixedPhase + inc;
+            wraps = periods + (next < fixedPhase);
+            fixedPhase = next;
+            lastInc = sampleInc;
+            old = out[i];
+        }
+        wrapped = out[nframes - 1];
+    } else {
+        double inc = (double)speed * freq / sampleRate;
+        // the whole block of phases in one go
+        double start = phase + offset;
+        start -= std::floor(start);
+        ofxControlSimd::phaseRamp(out, (float)start, (float)inc, nframes);
+        // find the new periods. the first sample ends the last step before this block, the others are found
+        // from the wrapped phases (same as in ofxNoiseOsc::shape)
+        float old = wrapped;
+        for (int i = 0; i < nframes; ++i){
+            float w = out[i];
+            int64_t n = (i > 0) ? _ofxOscNumPeriods(old, w, inc) : (bReset ? 0 : wraps);
+            if (n != 0){
+                firePeriods(std::abs(n), n > 0, old, w, (i > 0) ? inc : lastInc, 1.0 / sampleRate, (i - 1) / sampleRate);
+            }
+            old = w;
+        }
         bReset = false;
-        phase += speed * freq / ofxControl::getFrameRate();
-        phase = fmod(phase + numeric_limits<float>::epsilon(), 1.0); // add a very little offset to compensate for precision errors.
-        if (phase < 0.0){
-            phase += 1.0;
+        lastInc = inc;
+        wrapped = old;
+        // the step from the last sample to the start of the next block
+        wraps = (int64_t)(std::floor(start + inc * nframes) - std::floor(start + inc * (nframes - 1)));
+        double next = phase + inc * nframes;
+        phase = next - std::floor(next);
+    }
+    shape(out, nframes);
+}
+
+void ofxBaseOsc::shape(float* /* buf */, int /* n */) const {
+    // value equals wrapped phase
+}
+
+void ofxBaseOsc::firePeriods(int64_t n, bool rising, float old, float newPhase, double inc, double dt, double start){
+    newPeriods(n, rising);
+    for (int64_t k = 0; k < n; ++k){
+        double offset = start + _ofxOscPeriodPosition(old, newPhase, rising, inc, k, n) * dt;
+        fireEvents((float)std::max(0.0, offset));
+        ++counter;
+    }
+}
+
+void ofxBaseOsc::newPeriods(int64_t /* n */, bool /* rising */){
+}
+
+void ofxBaseOsc::fireEvents(float offset){
+    if (eventMap.empty()){
+        return;
+    }
+    // a callback might add or remove listeners (even itself), so the map is held while the callbacks are called in place
+    eventMap.hold();
+    if (eventMap.size() == 1){
+        ofxControl::fire(eventMap.at(eventMap.first()), offset);
+    } else {
+        /* collect the handles first (see ofxOscBank::update), so listeners which are added by a callback
+         * are not called before the next period. the list is used as a stack, so nested updates are fine. */
+        static thread_local std::vector<ofxControlHandle> firing;
+        size_t start = firing.size();
+        for (uint32_t index = eventMap.first(); index != eventMap.npos; index = eventMap.next(index)){
+            firing.push_back(eventMap.handle(index));
+        }
+        size_t end = firing.size();
+        for (size_t i = start; i < end; ++i){
+            ofxControlCallback* callback = eventMap.get(firing[i]);
+            if (callback){
+                ofxControl::fire(*callback, offset);
+            }
         }
+        firing.resize(start);
     }
+    eventMap.release();
+}
+
+// fractional part of a phase as 0.64 fixed point number
+uint64_t ofxBaseOsc::toFixed(float phase){
+    double f = (double)phase - std::floor((double)phase);
+    // a float has at most 24 significant bits, so 'f' is always < 1 and the result can't overflow
+    return (uint64_t)(f * 18446744073709551616.0);
+}
+
+float ofxBaseOsc::fromFixed(uint64_t phase){
+    // use the upper 24 bits, so the result is always < 1
+    return (float)(phase >> 40) * (1.f / 16777216.f);
 }
 
 float ofxBaseOsc::out() const {
@@ -539,6 +1611,8 @@ float ofxBaseOsc::getPeriod() const {
 void ofxBaseOsc::setPhase(float newPhase){
     phase = newPhase;
     bReset = true;
+    fixedPhase = toFixed(newPhase + offset);
+    wraps = 0;
 }
 
 float ofxBaseOsc::getPhase() const{
@@ -546,6 +1620,8 @@ float ofxBaseOsc::getPhase() const{
 }
 
 void ofxBaseOsc::setPhaseOffset(float newOffset){
+    // FIXED mode: shift the accumulator (doesn't trigger events)
+    fixedPhase += toFixed(newOffset) - toFixed(offset);
     offset = newOffset;
 }
 
@@ -553,8 +1629,38 @@ float ofxBaseOsc::getPhaseOffset() const{
     return offset;
 }
 
+void ofxBaseOsc::setPhaseMode(ofxOscPhaseMode mode){
+    if (mode != phaseMode){
+        if (mode == ofxOscPhaseMode::FIXED){
+            fixedPhase = toFixed(phase + offset);
+            wraps = 0;
+            updateIncrement(timeDomain->getDeltaTime());
+        } else {
+            phase = fromFixed(fixedPhase - toFixed(offset));
+            bReset = true;
+        }
+        phaseMode = mode;
+    }
+}
+
+ofxOscPhaseMode ofxBaseOsc::getPhaseMode() const {
+    return phaseMode;
+}
+
+bool ofxBaseOsc::remove(ofxControlHandle handle){
+    return eventMap.erase(handle);
+}
+
+bool ofxBaseOsc::isAdded(ofxControlHandle handle) const {
+    return eventMap.contains(handle);
+}
+
 void ofxBaseOsc::removeAll(){
-    eventList.clear();
+    eventMap.clear();
+}
+
+void ofxBaseOsc::reserve(int numListeners){
+    eventMap.reserve(std::max(0, numListeners));
 }
 
 int ofxBaseOsc::getCounter() const {
@@ -565,16 +1671,78 @@ void ofxBaseOsc::resetCounter(){
     counter = 0;
 }
 
+ofxControlStateType ofxBaseOsc::getStateType() const {
+    return ofxControlStateType::OSC;
+}
+
+void ofxBaseOsc::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseControl::saveState(writer);
+    writer.write(freq);
+    writer.write(wrapped);
+    writer.write(phase);
+    writer.write(offset);
+    writer.write(counter);
+    writer.write((uint8_t)bReset);
+    writer.write(phaseMode);
+    writer.write(fixedPhase);
+    writer.write(fixedPeriods);
+    writer.write(fixedInc);
+    writer.write(wraps);
+    writer.write(lastInc);
+    writer.write(incFreq);
+    writer.write(incSpeed);
+    writer.write(incDt);
+    // event listeners in insertion order
+    size_t countPos = writer.reserveCount();
+    uint32_t count = 0;
+    for (uint32_t index = eventMap.first(); index != eventMap.npos; index = eventMap.next(index)){
+        uint64_t id;
+        if (writer.writeEvent(eventMap.handle(index), id)){
+            ++count;
+        }
+    }
+    writer.writeCount(countPos, count);
+}
+
+bool ofxBaseOsc::restoreState(ofxControlStateReader& reader){
+    if (!ofxBaseControl::restoreState(reader)){
+        return false;
+    }
+    uint8_t reset;
+    uint32_t numListeners;
+    if (!reader.read(freq) || !reader.read(wrapped) || !reader.read(phase) || !reader.read(offset)
+            || !reader.read(counter) || !reader.read(reset) || !reader.read(phaseMode)
+            || !reader.read(fixedPhase) || !reader.read(fixedPeriods) || !reader.read(fixedInc)
+            || !reader.read(wraps) || !reader.read(lastInc) || !reader.read(incFreq)
+            || !reader.read(incSpeed) || !reader.read(incDt)
+            || !reader.readCount(numListeners, sizeof(uint64_t))){
+        return false;
+    }
+    bReset = reset != 0;
+    eventMap.clear();
+    for (uint32_t i = 0; i < numListeners; ++i){
+        uint64_t id;
+        ofxControlCallback callback;
+        if (!reader.readEvent(id, callback)){
+            return false;
+        }
+        if (callback){
+            reader.restored(id, eventMap.insert(std::move(callback)));
+        }
+    }
+    return true;
+}
+
 
 // protected function to remove listeners from event list
-void ofxBaseOsc::searchAndRemove(ofxControlBaseEvent* testobj){
-    auto event = eventList.begin();
-    while (event != eventList.end()){
-        if ((*event)->compare(testobj)){
-            event = eventList.erase(event);
-        } else {
-            ++event;
+void ofxBaseOsc::searchAndRemove(const ofxControlCallback& test){
+    uint32_t index = eventMap.first();
+    while (index != eventMap.npos){
+        uint32_t next = eventMap.next(index);
+        if (eventMap.at(index).matches(test)){
+            eventMap.eraseAt(index);
         }
+        index = next;
     }
 }
 
@@ -593,11 +1761,34 @@ void ofxBaseOsc::searchAndRemove(ofxControlBaseEvent* testobj){
 /// ofxSinOsc / ofxCosOsc
 
 float ofxSinOsc::out() const {
-    return sin(wrapped*TWO_PI);
+    return ofxControl::isFast() ? ofxControlFastMath::sin2pi(wrapped) : std::sin(wrapped*OFXCONTROL_TWO_PI);
+}
+
+void ofxSinOsc::shape(float* buf, int n) const {
+    if (ofxControl::isFast()){
+        ofxControlSimd::sin2pi(buf, buf, 0.f, n);
+    } else {
+        for (int i = 0; i < n; ++i){
+            buf[i] = std::sin(buf[i]*OFXCONTROL_TWO_PI);
+        }
+    }
 }
 
+ofxCosOsc::~ofxCosOsc() {}
+
 float ofxCosOsc::out() const {
-    return cos(wrapped*TWO_PI);
+    return ofxControl::isFast() ? ofxControlFastMath::cos2pi(wrapped) : std::cos(wrapped*OFXCONTROL_TWO_PI);
+}
+
+void ofxCosOsc::shape(float* buf, int n) const {
+    if (ofxControl::isFast()){
+        // cos(x) = sin(x + PI/2)
+        ofxControlSimd::sin2pi(buf, buf, 0.25f, n);
+    } else {
+        for (int i = 0; i < n; ++i){
+            buf[i] = std::cos(buf[i]*OFXCONTROL_TWO_PI);
+        }
+    }
 }
 
 
@@ -620,6 +1811,12 @@ float ofxPulseOsc::out() const {
     return (wrapped < width);
 }
 
+void ofxPulseOsc::shape(float* buf, int n) const {
+    for (int i = 0; i < n; ++i){
+        buf[i] = (buf[i] < width);
+    }
+}
+
 void ofxPulseOsc::setPulseWidth(float w){
     width = std::max(0.f, std::min(1.f, w));
 }
@@ -628,6 +1825,19 @@ float ofxPulseOsc::getPulseWidth() const {
     return width;
 }
 
+ofxControlStateType ofxPulseOsc::getStateType() const {
+    return ofxControlStateType::PULSE_OSC;
+}
+
+void ofxPulseOsc::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseOsc::saveState(writer);
+    writer.write(width);
+}
+
+bool ofxPulseOsc::restoreState(ofxControlStateReader& reader){
+    return ofxBaseOsc::restoreState(reader) && reader.read(width);
+}
+
 /*--------------------------------------------------------------------------*/
 
 /// ofxTriOsc
@@ -645,16 +1855,26 @@ void ofxTriOsc::init() {
 }
 
 float ofxTriOsc::out() const {
+    return shapeTri(wrapped, vertex);
+}
+
+void ofxTriOsc::shape(float* buf, int n) const {
+    for (int i = 0; i < n; ++i){
+        buf[i] = shapeTri(buf[i], vertex);
+    }
+}
+
+float ofxTriOsc::shapeTri(float phase, float vertex){
     if (vertex == 0.f){
         // actually reversed sawtooth
-        return 1.f - wrapped;
+        return 1.f - phase;
     }
     else if (vertex == 1.f){
         // actually sawtooth
-        return wrapped;
+        return phase;
     }
     else {
-        float x = wrapped - vertex;
+        float x = phase - vertex;
         x = (x < 0.f) ? x / (-vertex) : x/(1-vertex);
         x *= -1;
         x += 1;
@@ -669,12 +1889,174 @@ float ofxTriOsc::getVertex() const {
     return vertex;
 }
 
+ofxControlStateType ofxTriOsc::getStateType() const {
+    return ofxControlStateType::TRI_OSC;
+}
+
+void ofxTriOsc::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseOsc::saveState(writer);
+    writer.write(vertex);
+}
+
+bool ofxTriOsc::restoreState(ofxControlStateReader& reader){
+    return ofxBaseOsc::restoreState(reader) && reader.read(vertex);
+}
+
 
 /*--------------------------------------------------------------------------*/
 
 /// ofxNoiseOsc
 
-// ofxLineShape for noise shape
+ofxNoiseOsc::ofxNoiseOsc() {
+    stream = ofxControl::newStream();
+    init();
+}
+
+ofxNoiseOsc::~ofxNoiseOsc() {}
+
+void ofxNoiseOsc::init() {
+    type = UNIFORM;
+    a = 0.f;
+    b = 1.f;
+    newShape = curShape = ofxNoiseShape::LIN;
+    newCoeff = curCoeff = 0.f;
+    shaper.prepare(curShape, curCoeff);
+    index = 0;
+    ofxBaseOsc::init();
+    updateValues();
+}
+
+float ofxNoiseOsc::out() const {
+    return from + (to - from) * shaper.direct(wrapped);
+}
+
+void ofxNoiseOsc::shape(float* buf, int n) const {
+    /* the last sample belongs to the current period. walk backwards and step back to the previous period(s)
+     * wherever 'process' has detected new periods (same condition), so every sample gets the values of its own period. */
+    uint32_t key = ofxControlRandom::hash(ofxControl::getSeed(), stream);
+    uint32_t k = index;
+    float x0 = from;
+    float x1 = to;
+    for (int i = n - 1; i >= 0; --i){
+        float w = buf[i];
+        buf[i] = x0 + (x1 - x0) * shaper.direct(w);
+        if (i > 0){
+            int64_t periods = _ofxOscNumPeriods(buf[i - 1], w, lastInc);
+            if (periods != 0){
+                // (unsigned arithmetic, see 'newPeriods')
+                k -= (uint32_t)periods;
+                x0 = value(key, k);
+                x1 = value(key, k + 1);
+            }
+        }
+    }
+}
+
+void ofxNoiseOsc::newPeriods(int64_t n, bool rising){
+    // (unsigned arithmetic, so the index can wrap around in both directions)
+    if (rising){
+        index += (uint32_t)n;
+    } else {
+        index -= (uint32_t)n;
+    }
+    curShape = newShape;
+    curCoeff = newCoeff;
+    shaper.prepare(curShape, curCoeff);
+    updateValues();
+}
+
+float ofxNoiseOsc::value(uint32_t key, uint32_t n) const {
+    if (type == NORMAL){
+        // the second number comes from a different stream
+        return a + b * ofxControlRandom::normal(ofxControlRandom::hash(key, n),
+                                                ofxControlRandom::hash(key + 0x9e3779b9U, n));
+    } else {
+        return a + (b - a) * ofxControlRandom::uniform(ofxControlRandom::hash(key, n));
+    }
+}
+
+void ofxNoiseOsc::updateValues(){
+    uint32_t key = ofxControlRandom::hash(ofxControl::getSeed(), stream);
+    from = value(key, index);
+    to = value(key, index + 1);
+}
+
+void ofxNoiseOsc::setUniform(float high, float low){
+    type = UNIFORM;
+    a = low;
+    b = high;
+    updateValues();
+}
+
+bool ofxNoiseOsc::isUniform() const {
+    return type == UNIFORM;
+}
+
+void ofxNoiseOsc::setNormal(float stddev, float mean){
+    type = NORMAL;
+    a = mean;
+    b = stddev;
+    updateValues();
+}
+
+bool ofxNoiseOsc::isNormal() const {
+    return type == NORMAL;
+}
+
+void ofxNoiseOsc::setNoiseShape(ofxNoiseShape shape, float coeff){
+    newShape = shape;
+    newCoeff = coeff;
+}
+
+ofxNoiseShape ofxNoiseOsc::getNoiseShape() const {
+    return newShape;
+}
+
+void ofxNoiseOsc::setStream(uint32_t id){
+    stream = id;
+    updateValues();
+}
+
+uint32_t ofxNoiseOsc::getStream() const {
+    return stream;
+}
+
+void ofxNoiseOsc::seed(int val){
+    ofxControl::setSeed((uint32_t)val);
+}
+
+ofxControlStateType ofxNoiseOsc::getStateType() const {
+    return ofxControlStateType::NOISE_OSC;
+}
+
+void ofxNoiseOsc::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseOsc::saveState(writer);
+    writer.write((uint32_t)type);
+    writer.write(newShape);
+    writer.write(newCoeff);
+    writer.write(curShape);
+    writer.write(curCoeff);
+    writer.write(a);
+    writer.write(b);
+    writer.write(stream);
+    writer.write(index);
+    // the values themselves, so they don't depend on the global seed of the restoring program
+    writer.write(from);
+    writer.write(to);
+}
+
+bool ofxNoiseOsc::restoreState(ofxControlStateReader& reader){
+    uint32_t newType;
+    if (!ofxBaseOsc::restoreState(reader) || !reader.read(newType) || !reader.read(newShape)
+            || !reader.read(newCoeff) || !reader.read(curShape) || !reader.read(curCoeff)
+            || !reader.read(a) || !reader.read(b) || !reader.read(stream) || !reader.read(index)
+            || !reader.read(from) || !reader.read(to)){
+        return false;
+    }
+    type = (newType == NORMAL) ? NORMAL : UNIFORM;
+    shaper.prepare(curShape, curCoeff);
+    return true;
+}
 
 
 /*--------------------------------------------------------------------------*/
@@ -687,6 +2069,9 @@ float ofxTriOsc::getVertex() const {
 void ofxMetro::forceNext(){
     phase = 0.f;
     bReset = false;
+    fixedPhase = toFixed(offset);
+    wraps = 1;
+    lastInc = 0; // exactly one new period
 }
 
 
@@ -708,8 +2093,12 @@ void ofxTimer::init(){
 }
 
 void ofxTimer::update(){
+    ofxTimer::update((float)timeDomain->getDeltaTime());
+}
+
+void ofxTimer::update(float dt){
    if (bRunning){
-        elapsed += speed / ofxControl::getFrameRate();
+        elapsed += speed * dt;
     }
 }
 
@@ -720,3 +2109,16 @@ void ofxTimer::reset(){
 float ofxTimer::getTime() const {
     return elapsed;
 }
+
+ofxControlStateType ofxTimer::getStateType() const {
+    return ofxControlStateType::TIMER;
+}
+
+void ofxTimer::saveState(ofxControlStateWriter& writer) const {
+    ofxBaseControl::saveState(writer);
+    writer.write(elapsed);
+}
+
+bool ofxTimer::restoreState(ofxControlStateReader& reader){
+    return ofxBaseControl::restoreState(reader) && reader.read(elapsed);
+}
@@ -1,8 +1,19 @@
 #pragma once
 
-#include "ofMain.h"
-#include <list>
-#include <random>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "ofxControlSlotMap.h"
+#include "ofxControlPool.h"
+#include "ofxControlCallback.h"
+#include "ofxControlRingBuffer.h"
+#include "ofxControlSimd.h"
+#include "ofxControlMath.h"
 
 #define OFXCONTROL_DEFAULT_RATE 30
 
@@ -11,32 +22,157 @@
 
 */
 
-/* Static class which holds the global frame rate for all ofxBaseControl and derived classes.
+/// ofxControlTimeDomain
+/* A clock source for control objects: the rate at which they are updated.
+ * Every control is attached to a time domain (see ofxBaseControl::setTimeDomain) and advances
+ * by the domain's frame duration on every call to 'update'. The duration is computed once
+ * when the rate is set, so updating a control costs a multiplication instead of a division.
+ *
+ * By default, all controls use the default domain of ofxControl (see below). Controls which are updated
+ * at a different rate, e.g. on a 1 kHz control thread, get their own domain:
+ *
+ * ofxControlTimeDomain controlRate(1000);
+ * line.setTimeDomain(&controlRate);
+ * // control thread
+ * line.update(); // advances by 1 ms
+ *
+ * For a variable frame rate, set the duration of each frame with 'setDeltaTime' (e.g. ofGetLastFrameTime()),
+ * or pass the time step directly to the controls with 'update(dt)'.
+ * A time domain must outlive the controls attached to it. */
+
+class ofxControlTimeDomain {
+public:
+    constexpr ofxControlTimeDomain(float fps = OFXCONTROL_DEFAULT_RATE)
+        : fps(fps > 0 ? fps : OFXCONTROL_DEFAULT_RATE),
+          dt(1.0 / (fps > 0 ? fps : OFXCONTROL_DEFAULT_RATE)) {}
+    void setFrameRate(float newFps){
+        fps = (newFps > 0) ? newFps : OFXCONTROL_DEFAULT_RATE;
+        dt = 1.0 / fps;
+    }
+    float getFrameRate() const { return fps; }
+    // set the frame duration in seconds (same as setFrameRate(1 / seconds))
+    void setDeltaTime(double seconds){
+        if (seconds > 0){
+            dt = seconds;
+            fps = 1.0 / seconds;
+        }
+    }
+    double getDeltaTime() const { return dt; }
+private:
+    float fps;
+    double dt;
+};
+
+/* Static class which holds the default time domain for all ofxBaseControl and derived classes.
  * You could either set the frame rate to fixed value in the setup routine of your app,
  * or update it to the actual rate in your update routine like this:
  * ofxControl::setFrameRate(ofGetFrameRate());
  *
  * WARNING: ofGetFrameRate() uses some smoothing which can cause subtle bugs with your ofxControlObjects,
  * especially on startup, where the value ramps up from 0 to the actual frame rate
+ *
+ * The class also holds the global precision mode for oscillators and line shapes:
+ * PRECISE uses the standard math library, FAST uses the polynomial approximations
+ * in ofxControlFastMath (max. error around 1e-6, see ofxControlMath.h), which are several times faster.
  */
 
+enum class ofxControlPrecision {
+    PRECISE,
+    FAST
+};
+
+// an event which has been collected during a parallel update (see ofxControlRegistry::setNumThreads)
+struct _ofxControlDeferredEvent {
+    // position of the control in the update order
+    uint32_t control;
+    // order of the events of the same control
+    uint32_t sequence;
+    // time offset within the update (see ofxControl::fire)
+    float offset;
+    ofxControlCallback callback;
+};
+
+// collects the events of the controls updated by a worker thread
+class _ofxControlEventSink {
+public:
+    void setControl(uint32_t index){
+        control = index;
+        sequence = 0;
+    }
+    void push(ofxControlCallback&& callback, float offset){
+        events.push_back(_ofxControlDeferredEvent{ control, sequence++, offset, std::move(callback) });
+    }
+    std::vector<_ofxControlDeferredEvent> events;
+private:
+    uint32_t control = 0;
+    uint32_t sequence = 0;
+};
+
 class ofxControl {
 public:
     ofxControl() = delete;
+    // frame rate of the default time domain
     static void setFrameRate(float fps);
     static float getFrameRate();
+    static ofxControlTimeDomain& getDefaultTimeDomain() { return _defaultDomain; }
+    static void setPrecision(ofxControlPrecision precision);
+    static ofxControlPrecision getPrecision();
+    static bool isFast() { return _precision == ofxControlPrecision::FAST; }
+    /* global seed of the random number generators (see ofxControlRandom and ofxNoiseOsc).
+     * every random stream is derived from the seed and a stream id, so the same seed gives the same results. */
+    static void setSeed(uint32_t seed);
+    static uint32_t getSeed();
+    // get a new stream id (0, 1, 2, ... in order of the calls)
+    static uint32_t newStream();
+    /* call an event, or collect it if it is dispatched later by ofxControlRegistry.
+     * 'offset' is the time (in seconds) between the start of the update and the exact moment of the event. */
+    static void fire(ofxControlCallback& callback, float offset){
+        if (_sink){
+            _sink->push(ofxControlCallback(callback), offset);
+        } else {
+            callback(offset);
+        }
+    }
+    static void fire(ofxControlCallback&& callback, float offset){
+        if (_sink){
+            _sink->push(std::move(callback), offset);
+        } else {
+            callback(offset);
+        }
+    }
 private:
-    static float _fps;
+    static ofxControlTimeDomain _defaultDomain;
+    static ofxControlPrecision _precision;
+    static std::atomic<uint32_t> _seed;
+    static std::atomic<uint32_t> _numStreams;
+    // event sink of the current thread (only set while ofxControlRegistry collects events)
+    static thread_local _ofxControlEventSink* _sink;
+    friend class ofxControlRegistry;
 };
 
 
 // forward declaration of event classes
-class ofxControlBaseEvent;
 template<typename T> class ofxControlVarEvent;
 template<typename TArg, typename TReturn, typename TObj> class ofxControlFuncEvent;
 
 
 
+class ofxBaseControl;
+// see ofxControlState.h
+enum class ofxControlStateType : uint32_t;
+class ofxControlStateWriter;
+class ofxControlStateReader;
+
+// the part of the per-type groups of ofxControlRegistry which the controls need to know about (see ofxControlRegistry.h)
+class _ofxControlGroupBase {
+public:
+    virtual ~_ofxControlGroupBase() {}
+    // put a control (back) into the active set
+    virtual void activate(ofxBaseControl* control) = 0;
+    // unregister a control which is about to be destroyed
+    virtual void release(ofxBaseControl* control) = 0;
+};
+
 /// common base class for all ofxControl classes
 
 class ofxBaseControl {
@@ -44,15 +180,45 @@ public:
     ofxBaseControl();
     virtual ~ofxBaseControl();
     virtual void init();
-    virtual void update() = 0; // must be implemented
+    // advance by the frame duration of the time domain, i.e. update(timeDomain->getDeltaTime())
+    virtual void update();
+    /* advance by 'dt' seconds (still scaled by the speed). must be implemented
+     * (custom controls: add 'using ofxBaseControl::update;', so the overload above stays visible) */
+    virtual void update(float dt) = 0;
+    // attach to a time domain (nullptr: the default time domain, see ofxControl)
+    void setTimeDomain(ofxControlTimeDomain* domain);
+    ofxControlTimeDomain* getTimeDomain() const;
     virtual void setSpeed(float newSpeed);
     virtual float getSpeed() const;
     virtual void pause();
     virtual void resume();
     virtual bool isRunning() const;
+    // true if 'update' wouldn't do anything (redefined by derived classes, used by ofxControlRegistry)
+    bool isIdle() const { return !bRunning; }
+    /* snapshots (see ofxControlState.h): the type of the state and functions for saving and restoring it.
+     * the base class saves the speed and the running state. custom controls with their own state
+     * override all three functions and call the functions of their base class first. */
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
     float speed;
     bool bRunning;
+    ofxControlTimeDomain* timeDomain;
+    // registry group the control belongs to (if any)
+    _ofxControlGroupBase* controlGroup;
+    // true if the control is in the active set of its registry group
+    bool bActive;
+    // position in the member list and the active set of the registry group
+    uint32_t groupIndex;
+    uint32_t activeIndex;
+    // tell the registry that the control has something to do again
+    void wake(){
+        if (controlGroup && !bActive){
+            controlGroup->activate(this);
+        }
+    }
+    template<typename T> friend class _ofxControlGroup;
 };
 
 /*--------------------------------------------------------------------*/
@@ -71,6 +237,40 @@ enum class ofxLineShape {
     S_CURVE
 };
 
+/// _ofxLineShaper
+/* Evaluates the shape of a line segment. All constants (exponents, denominators, etc.) are computed once in 'prepare'.
+ * 'eval' advances EXP shapes by a constant factor and COS shapes / S_CURVE by a rotation per frame,
+ * so a running segment costs a few multiply-adds instead of calls to exp/sin/cos.
+ * The recurrence is reseeded from the exact formula whenever the ramp position doesn't match the prediction
+ * (e.g. when the speed or frame rate has changed) and every 'renormInterval' steps to keep rounding errors from piling up. */
+
+class _ofxLineShaper {
+public:
+    static const int renormInterval = 32;
+    // compute the constants for a shape
+    void prepare(ofxLineShape shape, float coeff);
+    // exact value of the shape at a ramp position (0 - 1)
+    float direct(float ramp) const;
+    // value of the shape at a ramp position, when the next call is expected at 'ramp + delta'
+    float eval(float ramp, float delta);
+private:
+    ofxLineShape shape;
+    // EXP: (exp(sc * ramp) - 1) * norm, POW: pow(ramp, exponent), COS: angle = omega * ramp
+    double sc;
+    double norm;
+    double exponent;
+    double omega;
+    // recurrence state (EXP: x = exp(sc * ramp), COS: x = cos, y = sin)
+    double x, y;
+    // step per frame (EXP: x *= stepX, COS: rotation by (stepX, stepY))
+    double stepX, stepY;
+    float lastDelta;
+    double nextRamp;
+    int count;
+    bool bValid;
+    void seed(float ramp);
+};
+
 template<typename T>
 struct _ofxLineSegment {
     // ramp time
@@ -87,12 +287,25 @@ struct _ofxLineSegment {
 	float coeff;
     // elapsed time (used together with onset)
     float elapsed;
-    // callback actions, executed on segment end
-    list<unique_ptr<ofxControlBaseEvent>> eventList;
+    // ofxLine: end of the segment on the time axis of the queue, i.e. the sum of the onsets and ramp times
+    // of all segments up to this one (a prefix sum for 'valueAt' and 'seek')
+    double cumEnd;
+    // serial number, links the segment to its events in the line's event map
+    uint64_t id;
+    // shape evaluation
+    _ofxLineShaper shaper;
+};
+
+// an event listener for the end of a line segment
+struct _ofxLineEvent {
+    ofxControlCallback callback;
+    // id of the segment the event belongs to
+    uint64_t segment;
 };
 
 typedef _ofxLineSegment<float> ofxLineSegment;
-typedef _ofxLineSegment<vector<float>> ofxMultiLineSegment; 
+// values are aligned for the SIMD kernels (see ofxControlSimd)
+typedef _ofxLineSegment<ofxControlAlignedVector<float>> ofxMultiLineSegment;
 
 
 /// ofxLine
@@ -106,6 +319,7 @@ public:
     /* interface implementation */
     virtual void init();
 	virtual void update();
+	virtual void update(float dt);
 
     /* individual functions */
 	// get the current value
@@ -116,51 +330,132 @@ public:
     void setShape(ofxLineShape newShape, float newCoeff = 0);
     // add a new event listener for the end of the next segment(s), writing a value to a variable
     template<typename T>
-    void addOnSegmentEnd(T* var, const T & value);
+    ofxControlHandle addOnSegmentEnd(T* var, const T & value);
     // add a new event listener for the end of the next segment(s), calling a member function with no arguments
     template<typename TReturn, typename TObj>
-    void addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)());
+    ofxControlHandle addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)());
     // add a new event listener for the end of the next segment(s), calling a member function by a single argument
     template<typename TArg, typename TReturn, typename TObj>
-    void addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    ofxControlHandle addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    // add a new event listener for the end of the next segment(s), calling any function object (e.g. a lambda)
+    template<typename TFunc>
+    ofxControlHandle addOnSegmentEnd(TFunc&& func);
+    // remove a single event listener by its handle (O(1)), returns false if it has already fired or been removed
+    bool removeOnSegmentEnd(ofxControlHandle handle);
+    // check if an event listener is still waiting for its segment to end
+    bool isPending(ofxControlHandle handle) const;
     // clear event list (mostly redundand because event list is cleared automatically after each call to 'addSegment')
     void clearOnSegmentEnd();
+    // preallocate space for a number of segments and event listeners
+    void reserve(int numSegments, int numEvents = 0);
+    /* with a fixed capacity, 'addSegment' fails (returns false) when the segment queue is full instead of allocating memory.
+     * together with 'reserve' this makes the line safe to use in real-time threads. */
+    void setFixedCapacity(bool fixed);
+    bool isFixedCapacity() const;
     // add a new segment, specifing the target value, the ramp time
 	// and a time onset in relation to the end of the last segment
-    void addSegment(float targetValue, float rampTime = 0, float timeOnset = 0);
+    // (returns false if the segment queue is full, see 'setFixedCapacity')
+    bool addSegment(float targetValue, float rampTime = 0, float timeOnset = 0);
     // pop the last segment from the list
     void removeLastSegment();
     // pop current segment and move on to the next
     void nextSegment();
     // clear segment list (remove all segments)
 	void clear();
+    // true if there are no segments or the line is paused
+    bool isIdle() const { return !bRunning || segmentQueue.empty(); }
+    /* block processing (e.g. in an audio callback): advance the line by 'nframes' steps of speed / sampleRate
+     * and write the value after every step to 'out' (same as calling update() and out() at a frame rate of 'sampleRate').
+     * segment ends are sample accurate, the events are called at the step where the segment ends. */
+    void process(float* out, int nframes, float sampleRate);
+    /* random access: get the value 't' seconds after the current position without changing the line
+     * ('t' is segment time, i.e. the speed is ignored). the value after the next update is valueAt(0).
+     * the segment is found by binary search, so this is cheap enough for scrubbing through long timelines
+     * or drawing a preview of the whole envelope. */
+    float valueAt(float t) const;
+    // jump 't' seconds ahead. skipped segments are removed *without* calling their events.
+    void seek(float t);
+    // time from the current position to the end of the last segment
+    float getRemainingTime() const;
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
 	float value;
 	ofxLineShape shape;
 	float coeff;
-    // temporary event list
-    list<unique_ptr<ofxControlBaseEvent>> eventList;
+    // ramp time of the last step, which is the step that took the current segment past its end (see 'update')
+    float lastStep;
+    /* event listeners for all segments, in insertion order.
+     * events which have not been assigned to a segment yet carry the id of the next segment to be added,
+     * so 'addSegment' simply has to increment 'nextSegmentId'. because segments are added in order,
+     * the map is always sorted by segment id. */
+    ofxControlSlotMap<_ofxLineEvent> eventMap;
+    uint64_t nextSegmentId;
     // queue of segments
-    list<ofxLineSegment> segmentList;
+    ofxControlRingBuffer<ofxLineSegment> segmentQueue;
+    ofxControlHandle pushEvent(ofxControlCallback&& callback);
+    // set the target value of the current segment, call its events and move on to the next segment
+    void finishSegment(float offset);
+    // fire (and remove) the events of a finished segment
+    void fireSegmentEvents(uint64_t id, float offset);
+    // remove the events of all segments up to (and including) a certain id
+    void dropSegmentEvents(uint64_t id);
+    // remove the events of the last segment
+    void dropLastSegmentEvents(uint64_t id);
+    // current position on the time axis of the queue (see 'cumEnd')
+    double getPosition() const;
+    // index of the segment which contains a position (or the size of the queue if it lies behind the last segment)
+    size_t findSegment(double pos) const;
+    // value of a segment at a position
+    float evalSegment(size_t index, double pos) const;
+    // save / restore the event listeners (shared with ofxMultiLine)
+    void saveEvents(ofxControlStateWriter& writer) const;
+    bool restoreEvents(ofxControlStateReader& reader);
 };
 
 // add a new event listener for the end of the next segment(s), writing a value to a variable
 template<typename T>
-void ofxLine::addOnSegmentEnd(T* var, const T & value){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlVarEvent<T>(var, value)));
+ofxControlHandle ofxLine::addOnSegmentEnd(T* var, const T & value){
+    return pushEvent(ofxControlVarEvent<T>(var, value));
 }
 // add a new event listener for the end of the next segment(s), calling a member function with no arguments
 template<typename TReturn, typename TObj>
-void ofxLine::addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)()){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<void, TReturn, TObj>(obj, func)));
+ofxControlHandle ofxLine::addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)()){
+    return pushEvent(ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
 }
 
 // add a new event listener for the end of the next segment(s), calling a member function by a single argument
 template<typename TArg, typename TReturn, typename TObj>
-void ofxLine::addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg)));
+ofxControlHandle ofxLine::addOnSegmentEnd(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
+    return pushEvent(ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg));
+}
+
+// add a new event listener for the end of the next segment(s), calling any function object
+template<typename TFunc>
+ofxControlHandle ofxLine::addOnSegmentEnd(TFunc&& func){
+    return pushEvent(ofxControlCallback(std::forward<TFunc>(func)));
 }
 
+/// ofxControlFloatView
+// read-only view of a contiguous array of floats (doesn't own the memory!)
+
+struct ofxControlFloatView {
+    ofxControlFloatView(const float* _data = nullptr, size_t _size = 0)
+        : ptr(_data), count(_size) {}
+    const float* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const float* begin() const { return ptr; }
+    const float* end() const { return ptr + count; }
+    // no range checking!
+    float operator[](size_t index) const { return ptr[index]; }
+private:
+    const float* ptr;
+    size_t count;
+};
+
 /// ofxMultiLine
 // change several float values over time by a queue of line segments
 
@@ -173,22 +468,27 @@ public:
     /* interface implementation */
     virtual void init();
 	virtual void update();
+	virtual void update(float dt);
 
     /* redefined functions */
 
     // add new segment
-    void addSegment(const vector<float> & targetValues, float rampTime, float timeOnset = 0);
+    bool addSegment(const std::vector<float> & targetValues, float rampTime, float timeOnset = 0);
 
-    // get all values as a vector
-    vector<float> out() const; //
+    // get all values as a vector (makes a copy!)
+    std::vector<float> out() const;
     void removeLastSegment();
     void nextSegment();
     void clear();
+    // preallocate segments (including their value vectors for the current number of lines) and event listeners
+    void reserve(int numSegments, int numEvents = 0);
+    void setFixedCapacity(bool fixed);
+    bool isFixedCapacity() const;
 
     /* new functions: */
 
     // clear all line segments and set values immediatly
-    void setValues(const vector<float> & newValues);
+    void setValues(const std::vector<float> & newValues);
     void setValues(float newValue);
 	// set number of lines
     void setNumLines(int numLines);
@@ -196,13 +496,37 @@ public:
     int getNumLines() const;
     // get the current value at a certain index
 	float operator[](int index) const;
+
+    /* zero-copy access to the current values. the pointer (and view) stay valid until
+     * the number of lines changes or 'setValues' is called with a vector of different size */
+    // get a view of all current values (no range checking)
+    ofxControlFloatView values() const;
+    // get a pointer to the current values (getNumLines() floats)
+    const float* data() const;
+    // copy all current values to a buffer, which must hold at least getNumLines() floats
+    void copyTo(float* dst) const;
+    // copy up to 'maxCount' current values to a buffer, returns the number of copied values
+    int copyTo(float* dst, int maxCount) const;
+    // true if there are no segments or the line is paused
+    bool isIdle() const { return !bRunning || multiSegmentQueue.empty(); }
+    // block processing (see ofxLine::process). the values are interleaved: 'out' must hold nframes * getNumLines() floats.
+    void process(float* out, int nframes, float sampleRate);
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
+
+    // ofxMultiLine is no ofxLine (private inheritance), but the registry has to treat it as ofxBaseControl
+    template<typename T> friend class _ofxControlGroup;
 protected:
-    vector<float> valueVec;
-    // segment list
-    list<ofxMultiLineSegment> multiSegmentList;
+    // current values (aligned for the SIMD kernels)
+    ofxControlAlignedVector<float> valueVec;
+    // queue of segments (popped segments keep their value vectors for reuse)
+    ofxControlRingBuffer<ofxMultiLineSegment> multiSegmentQueue;
+    void finishSegment(float offset);
 private:
     // hide setValue
-    setValue(float newValue);
+    void setValue(float newValue);
 };
 
 /*------------------------------------------------------------------------*/
@@ -210,6 +534,70 @@ private:
 /// ofxClock
 // list of clocks performing some task on time out. 
 
+// heap entry for a pending clock: the absolute deadline (in clock time) and the handle of the event to fire.
+// cancelled clocks leave a stale entry in the heap which is skipped when it comes up.
+struct _ofxClockEntry {
+    double deadline;
+    uint64_t order;
+    ofxControlHandle handle;
+};
+
+// a cue of an ofxClockCueList (see ofxClockCueList.h): 'time' is relative to the start of the list,
+// 'id' and 'value' are passed to the cue callback of the clock.
+struct ofxClockCue {
+    double time;
+    uint32_t id;
+    float value;
+};
+
+class ofxClockCueList;
+typedef std::shared_ptr<const ofxClockCueList> ofxClockCueListPtr;
+// called for every cue, with the time offset of the cue within the current update (see ofxControlCallback)
+typedef std::function<void(const ofxClockCue& cue, float offset)> ofxClockCueCallback;
+
+// a cue list which is being played by an ofxClock
+struct _ofxClockCues {
+    ofxClockCueListPtr list;
+    // shared with the pending cue events, so a callback can safely replace the cue list
+    std::shared_ptr<ofxClockCueCallback> callback;
+    // clock time at the start of the cue list
+    double start;
+    // index of the next cue and number of cues
+    size_t next;
+    size_t count;
+};
+
+// an owning pointer which copies the object along with the owner.
+// used for state which most instances don't need, to keep the objects small.
+template<typename T>
+class _ofxControlBox {
+public:
+    _ofxControlBox() {}
+    _ofxControlBox(const _ofxControlBox& other) : ptr(other.ptr ? new T(*other.ptr) : nullptr) {}
+    _ofxControlBox(_ofxControlBox&& other) : ptr(std::move(other.ptr)) {}
+    _ofxControlBox& operator=(const _ofxControlBox& other){
+        ptr.reset(other.ptr ? new T(*other.ptr) : nullptr);
+        return *this;
+    }
+    _ofxControlBox& operator=(_ofxControlBox&& other){
+        ptr = std::move(other.ptr);
+        return *this;
+    }
+    T* get() const { return ptr.get(); }
+    T* operator->() const { return ptr.get(); }
+    explicit operator bool() const { return ptr != nullptr; }
+    // create the object if necessary
+    T& emplace(){
+        if (!ptr){
+            ptr.reset(new T());
+        }
+        return *ptr;
+    }
+    void reset(){ ptr.reset(); }
+private:
+    std::unique_ptr<T> ptr;
+};
+
 class ofxClock : public ofxBaseControl {
 public:
 	ofxClock();
@@ -218,17 +606,26 @@ public:
     /* interface implementation */
     virtual void init();
 	virtual void update();
+	virtual void update(float dt);
 
     /* individual functions */
     // add a new clock, writing a value to a variable
     template<typename T>
-    void add(float delayTime, T* var, const T & value);
+    ofxControlHandle add(float delayTime, T* var, const T & value);
 	// add a new clock, calling a member function with no arguments
     template<typename TReturn, typename TObj>
-    void add(float delayTime, TObj* obj, TReturn(TObj::*func)());
+    ofxControlHandle add(float delayTime, TObj* obj, TReturn(TObj::*func)());
     // add a new clock, calling a member function by a single argument
     template<typename TArg, typename TReturn, typename TObj>
-    void add(float delayTime, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    ofxControlHandle add(float delayTime, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    // add a new clock, calling any function object (e.g. a lambda)
+    template<typename TFunc>
+    ofxControlHandle add(float delayTime, TFunc&& func);
+
+    // cancle a single clock by its handle (O(1)), returns false if it has already fired or been cancelled
+    bool cancel(ofxControlHandle handle);
+    // check if a clock is still pending
+    bool isPending(ofxControlHandle handle) const;
 	
 	// cancle all clocks writing a value to a certain variable
     template<typename T>
@@ -246,57 +643,124 @@ public:
     void cancelLast();
 	// cancle all clocks
 	void clear();
+    // number of pending clocks
+    int getNumPending() const;
+    // preallocate space for a number of clocks
+    void reserve(int numClocks);
+
+    /* play a cue list: 'callback' is called for every cue when 'cue.time' seconds (of clock time) have passed
+     * since this call, starting with the first cue at or after 'startTime'. Cues fire together with the clocks,
+     * cues with the same deadline as a clock fire first. Only one cue list can be played at a time,
+     * a new one replaces the old one and nullptr stops playing ('clear' doesn't affect the cues). */
+    void setCues(ofxClockCueListPtr cues, ofxClockCueCallback callback, double startTime = 0.0);
+    const ofxClockCueListPtr& getCues() const;
+    // number of cues which haven't fired yet
+    size_t getNumPendingCues() const { return cues ? cues->count - cues->next : 0; }
+    // true if there are no pending clocks and cues or the clock is paused
+    bool isIdle() const { return !bRunning || (clockMap.empty() && !getNumPendingCues()); }
+    // snapshots (see ofxControlState.h). the cue list is not saved and is stopped on restore.
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
-	list<unique_ptr<ofxControlBaseEvent>> clockList;
-    void searchAndRemove(ofxControlBaseEvent* testobj);
+    // pending events (in insertion order)
+    ofxControlSlotMap<ofxControlCallback> clockMap;
+    // deadlines of the pending clocks, kept as a binary min-heap
+    std::vector<_ofxClockEntry> clockHeap;
+    // elapsed clock time (advanced by speed * frame duration on every update)
+    double clockTime;
+    // insertion counter, used for ordering clocks with the same deadline
+    uint64_t clockOrder;
+    // cue list (see 'setCues'), only allocated when needed
+    _ofxControlBox<_ofxClockCues> cues;
+    ofxControlHandle push(float delayTime, ofxControlCallback&& callback);
+    void searchAndRemove(const ofxControlCallback& test);
+    void purgeHeap();
+    // advance the clock time by 'dt' seconds and fire the clocks which have timed out
+    void advance(double dt);
 };
 
 
 // add a new clock, writing a value to a variable
 template<typename T>
-void ofxClock::add(float delayTime, T* var, const T & value){
-    delayTime = (delayTime >= 0.0) ? delayTime : 0.0;
-    clockList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlVarEvent<T>(var, value, delayTime)));
+ofxControlHandle ofxClock::add(float delayTime, T* var, const T & value){
+    return push(delayTime, ofxControlVarEvent<T>(var, value));
 }
 // add a new clock, calling a member function with no arguments
 template<typename TReturn, typename TObj>
-void ofxClock::add(float delayTime, TObj* obj, TReturn(TObj::*func)()){
-    delayTime = (delayTime >= 0.0) ? delayTime : 0.0;
-    clockList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<void, TReturn, TObj>(obj, func, delayTime)));
+ofxControlHandle ofxClock::add(float delayTime, TObj* obj, TReturn(TObj::*func)()){
+    return push(delayTime, ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
 }
 
 // add a new clock, calling a member function by a single argument
 template<typename TArg, typename TReturn, typename TObj>
-void ofxClock::add(float delayTime, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
-    delayTime = (delayTime >= 0.0) ? delayTime : 0.0;
-    clockList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg, delayTime)));
+ofxControlHandle ofxClock::add(float delayTime, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
+    return push(delayTime, ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg));
+}
+
+// add a new clock, calling any function object
+template<typename TFunc>
+ofxControlHandle ofxClock::add(float delayTime, TFunc&& func){
+    return push(delayTime, ofxControlCallback(std::forward<TFunc>(func)));
 }
 
 // cancle all clocks writing a value to a certain variable
 template<typename T>
 void ofxClock::cancel(T* var){
-    T val{};
-    ofxControlVarEvent<T> test(var, val, 0);
-	searchAndRemove(&test);
+    searchAndRemove(ofxControlVarEvent<T>(var, T{}));
 }
 // cancle all clocks calling a certain member function by no arguments
 template<typename TReturn, typename TObj>
 void ofxClock::cancel(TObj* obj, TReturn(TObj::*func)()){
-    ofxControlFuncEvent<void, TReturn, TObj> test(obj, func, 0);
-	searchAndRemove(&test);
+    searchAndRemove(ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
 }
 // cancle all clocks calling a certain member function by a single argument
 template<typename TArg, typename TReturn, typename TObj>
 void ofxClock::cancel(TObj* obj, TReturn(TObj::*func)(TArg)){
-    TArg arg{};
-    ofxControlFuncEvent<TArg, TReturn, TObj> test(obj, func, arg, 0);
-	searchAndRemove(&test);
+    searchAndRemove(ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, TArg{}));
 }
 
 /*-------------------------------------------------------------------------*/
 
 /// ofxBaseOsc
-/* common base class for all oscillators */
+/* common base class for all oscillators
+ *
+ * The phase can be accumulated in two ways (see 'setPhaseMode'):
+ * FLOAT:  the phase is a float which is incremented and wrapped with fmod on every update (default).
+ * FIXED:  the wrapped phase is a 64 bit fixed point number where 2^64 equals one period, so wrapping is implicit
+ *         and a new period is detected by the carry of the addition. the increment is only recomputed when the
+ *         frequency, speed or frame rate has changed. there's no drift, even after days of uptime. */
+
+enum class ofxOscPhaseMode {
+    FLOAT,
+    FIXED
+};
+
+// where (0 - 1) a step from phase 'old' to phase 'wrapped' has crossed the start of a new period
+inline float _ofxOscWrapPosition(float old, float wrapped, bool rising){
+    float dist = rising ? (1.f - old) : old;
+    float total = rising ? (wrapped + 1.f - old) : (old + 1.f - wrapped);
+    return (total > 0.f) ? std::min(1.f, dist / total) : 0.f;
+}
+
+/* number of new periods (negative for negative frequencies) in a step of 'inc' periods from the wrapped phase 'old'
+ * to the wrapped phase 'wrapped'. the unwrapped phase 'old + inc' is a whole number of periods away from 'wrapped',
+ * so steps of one or more whole periods (where the wrapped phase doesn't go back) are counted as well. */
+inline int64_t _ofxOscNumPeriods(float old, float wrapped, double inc){
+    double n = std::floor((double)old + inc - (double)wrapped + 0.5);
+    // only count boundaries in the direction of the step
+    return ((inc > 0.0 && n > 0.0) || (inc < 0.0 && n < 0.0)) ? (int64_t)n : 0;
+}
+
+// where (0 - 1) the k-th of 'n' new periods has started in a step of 'inc' periods
+inline float _ofxOscPeriodPosition(float old, float wrapped, bool rising, double inc, int64_t k, int64_t n){
+    if (n == 1){
+        return _ofxOscWrapPosition(old, wrapped, rising);
+    }
+    double dist = (rising ? (1.0 - old) : old) + k;
+    double step = std::fabs(inc);
+    return (step > 0.0) ? (float)std::min(1.0, dist / step) : 0.f;
+}
 
 class ofxBaseOsc : public ofxBaseControl {
 public:
@@ -306,9 +770,14 @@ public:
     /* interface implementation */
     virtual void init();
     virtual void update();
+    virtual void update(float dt);
 
     /* new functions */
     virtual float out() const; // likely to be overwritten and implemented individually
+    /* block processing (e.g. in an audio callback): advance the oscillator by 'nframes' samples at 'sampleRate'
+     * and write the output for every sample to 'out'. events are called at the sample where the new period starts.
+     * changes made by the callbacks (frequency, phase, etc.) take effect at the next block. */
+    void process(float* out, int nframes, float sampleRate);
 
     // as these functions only affect base class members, we will probably never override them
     void setFrequency(float hz);
@@ -319,17 +788,27 @@ public:
     float getPhase() const;
     void setPhaseOffset(float newOffset);
     float getPhaseOffset() const;
+    void setPhaseMode(ofxOscPhaseMode mode); // the current phase is kept
+    ofxOscPhaseMode getPhaseMode() const;
 
     // add event listeners, being called right before the start of a new period
     // writing a value to a variable
     template<typename T>
-    void add(T* var, const T & value);
+    ofxControlHandle add(T* var, const T & value);
     // calling a member function with no arguments
     template<typename TReturn, typename TObj>
-    void add(TObj* obj, TReturn(TObj::*func)());
+    ofxControlHandle add(TObj* obj, TReturn(TObj::*func)());
     // calling a member function by a single argument
     template<typename TArg, typename TReturn, typename TObj>
-    void add(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    ofxControlHandle add(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    // calling any function object (e.g. a lambda)
+    template<typename TFunc>
+    ofxControlHandle add(TFunc&& func);
+
+    // remove a single event listener by its handle (O(1)), returns false if it has already been removed
+    bool remove(ofxControlHandle handle);
+    // check if an event listener is still installed
+    bool isAdded(ofxControlHandle handle) const;
 
     // remove all event listeners of certain type
     // writing a value to a certain variable
@@ -343,8 +822,14 @@ public:
     void remove(TObj* obj, TReturn(TObj::*func)(TArg));
 
     void removeAll();
+    // preallocate space for a number of event listeners
+    void reserve(int numListeners);
     int getCounter() const;
     void resetCounter();
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
     float freq;
     float wrapped;
@@ -352,48 +837,80 @@ protected:
     float offset;
     int counter;
     bool bReset;
-    list<unique_ptr<ofxControlBaseEvent>> eventList;
-    void searchAndRemove(ofxControlBaseEvent * testobj);
+    ofxControlSlotMap<ofxControlCallback> eventMap;
+    ofxOscPhaseMode phaseMode;
+    // FIXED mode: wrapped phase (including the offset) as 0.64 fixed point number
+    uint64_t fixedPhase;
+    // FIXED mode: increment per update, split into whole periods and the fractional part (0.64 fixed point)
+    int64_t fixedPeriods;
+    uint64_t fixedInc;
+    // number of periods started by the last step (negative for negative frequencies)
+    int64_t wraps;
+    // phase increment of the last step (in periods)
+    double lastInc;
+    // FIXED mode: parameters the increment has been computed for
+    float incFreq;
+    float incSpeed;
+    double incDt;
+    // advance by 'dt' seconds (in double precision, so long running oscillators stay in sync)
+    void advance(double dt);
+    void updateFloat(double dt);
+    void updateFixed(double dt);
+    void updateIncrement(double dt);
+    void fireEvents(float offset);
+    /* call the events for 'n' new periods in a step of 'inc' periods from phase 'old' to 'newPhase',
+     * which took 'dt' seconds and started 'start' seconds after the beginning of the update */
+    void firePeriods(int64_t n, bool rising, float old, float newPhase, double inc, double dt, double start);
+    // called right before the events of 'n' new periods (e.g. for picking new random values). does nothing by default.
+    virtual void newPeriods(int64_t n, bool rising);
+    /* turn a block of wrapped phases into output values (in place), i.e. 'out' for a whole block.
+     * if you override 'out' in a custom oscillator, override this as well! */
+    virtual void shape(float* buf, int n) const;
+    static void splitIncrement(double inc, int64_t& periods, uint64_t& fraction);
+    void searchAndRemove(const ofxControlCallback& test);
+    static uint64_t toFixed(float phase);
+    static float fromFixed(uint64_t phase);
 };
 
 
 // add a new event listener for the end of the next segment(s), writing a value to a variable
 template<typename T>
-void ofxBaseOsc::add(T* var, const T & value){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlVarEvent<T>(var, value)));
+ofxControlHandle ofxBaseOsc::add(T* var, const T & value){
+    return eventMap.insert(ofxControlVarEvent<T>(var, value));
 }
 // add a new event listener for the end of the next segment(s), calling a member function with no arguments
 template<typename TReturn, typename TObj>
-void ofxBaseOsc::add(TObj* obj, TReturn(TObj::*func)()){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<void, TReturn, TObj>(obj, func)));
+ofxControlHandle ofxBaseOsc::add(TObj* obj, TReturn(TObj::*func)()){
+    return eventMap.insert(ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
 }
 
 // add a new event listener for the end of the next segment(s), calling a member function by a single argument
 template<typename TArg, typename TReturn, typename TObj>
-void ofxBaseOsc::add(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
-    eventList.push_back(unique_ptr<ofxControlBaseEvent>(new ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg)));
+ofxControlHandle ofxBaseOsc::add(TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
+    return eventMap.insert(ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg));
+}
+
+// calling any function object
+template<typename TFunc>
+ofxControlHandle ofxBaseOsc::add(TFunc&& func){
+    return eventMap.insert(ofxControlCallback(std::forward<TFunc>(func)));
 }
 
 // add a new event listener for the end of the next segment(s), writing a value to a variable
 template<typename T>
 void ofxBaseOsc::remove(T* var){
-    T val{};
-    ofxControlVarEvent<T> test(var, val, 0);
-    searchAndRemove(&test);
+    searchAndRemove(ofxControlVarEvent<T>(var, T{}));
 }
 // add a new event listener for the end of the next segment(s), calling a member function with no arguments
 template<typename TReturn, typename TObj>
 void ofxBaseOsc::remove(TObj* obj, TReturn(TObj::*func)()){
-    ofxControlFuncEvent<void, TReturn, TObj> test(obj, func, 0);
-    searchAndRemove(&test);
+    searchAndRemove(ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
 }
 
 // add a new event listener for the end of the next segment(s), calling a member function by a single argument
 template<typename TArg, typename TReturn, typename TObj>
 void ofxBaseOsc::remove(TObj* obj, TReturn(TObj::*func)(TArg)){
-    TArg arg{};
-    ofxControlFuncEvent<TArg, TReturn, TObj> test(obj, func, arg, 0);
-    searchAndRemove(&test);
+    searchAndRemove(ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, TArg{}));
 }
 
 
@@ -414,12 +931,16 @@ using ofxPhasor = ofxBaseOsc;
 class ofxSinOsc : public ofxBaseOsc {
 public:
     virtual float out() const;
+protected:
+    virtual void shape(float* buf, int n) const;
 };
 
 class ofxCosOsc : public ofxBaseOsc {
 public:
     virtual ~ofxCosOsc();
     virtual float out() const;
+protected:
+    virtual void shape(float* buf, int n) const;
 };
 
 /*-------------------------------------------------------------------------*/
@@ -434,8 +955,13 @@ public:
     virtual float out() const;
     void setPulseWidth(float width);
     float getPulseWidth() const;
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
     float width;
+    virtual void shape(float* buf, int n) const;
 };
 
 /*--------------------------------------------------------------------------*/
@@ -450,6 +976,13 @@ public:
     virtual float out() const;
     void setVertex(float v);
     float getVertex() const;
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
+protected:
+    virtual void shape(float* buf, int n) const;
+    static float shapeTri(float phase, float vertex);
 private:
     float vertex;
 };
@@ -458,43 +991,68 @@ private:
 /*--------------------------------------------------------------------------*/
 
 /// ofxNoiseOsc
+/* Random values, one per period, with a smooth (or stepped) transition from one value to the next:
+ * during each period the output moves from the period's random value to the next one along the noise shape
+ * (the same curves as ofxLine segments, see ofxLineShape). With STEP, the output is a classic sample & hold.
+ * A negative frequency runs through the same values backwards.
+ *
+ * The values come from a counter based generator (see ofxControlRandom): value n of an oscillator is a pure function
+ * of the global seed (ofxControl::setSeed), the oscillator's stream id and n. New oscillators get a new stream id,
+ * so a program creating its oscillators in the same order gets the same noise on every run, no matter
+ * how many threads update them (see ofxControlRegistry). For noise in batch, see the NOISE waveform of ofxOscBank. */
 
 // ofxLineShape for noise shape
 using ofxNoiseShape = ofxLineShape;
 
 class ofxNoiseOsc : public ofxBaseOsc {
-private:
-    enum t_type {
-        UNIFORM,
-        NORMAL
-    } type;
 public:
     ofxNoiseOsc();
     virtual ~ofxNoiseOsc();
     virtual void init();
-    virtual float out();
+    virtual float out() const;
+    // evenly distributed values in [low, high) (default: 0 - 1)
     void setUniform(float high = 1.f, float low = 0.f);
+    bool isUniform() const;
+    // normal (gaussian) distribution
     void setNormal(float stddev = 1.f, float mean = 0.f);
-    void setNoiseShape(ofxNoiseShape shape, float coeff);
+    bool isNormal() const;
+    // curve from one value to the next (only updated on new period)
+    void setNoiseShape(ofxNoiseShape shape, float coeff = 0);
+    ofxNoiseShape getNoiseShape() const;
+    // choose the random stream (e.g. to give an oscillator the same noise as another one)
+    void setStream(uint32_t id);
+    uint32_t getStream() const;
+    // set the global seed (same as ofxControl::setSeed). oscillators pick it up at their next period.
     static void seed(int val);
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
+protected:
+    virtual void newPeriods(int64_t n, bool rising);
+    virtual void shape(float* buf, int n) const;
 private:
-    ofxNoiseShape newShape, _shape;
-    float newCoeff, _coeff;
+    enum t_type {
+        UNIFORM,
+        NORMAL
+    } type;
+    ofxNoiseShape newShape;
+    float newCoeff;
+    // shape of the current period
+    ofxNoiseShape curShape;
+    float curCoeff;
+    _ofxLineShaper shaper;
+    // UNIFORM: low and high, NORMAL: mean and standard deviation
     float a, b;
-    static default_random_engine gen;
+    uint32_t stream;
+    // number of the current period (counting down for negative frequencies)
+    uint32_t index;
+    // random values at the start and the end of the current period
+    float from, to;
+    float value(uint32_t key, uint32_t n) const;
+    void updateValues();
 };
 
-// setUniform(float high = 1.f, float low = 0.f)
-// isUniform()
-// setNormal(float stddev = 1.f, float mean = 0.f)
-// isNormal()
-
-// setNoiseShape() (only updated on new Period)
-
-// return (max * rand() / float(RAND_MAX)) * (1.0f - std::numeric_limits<float>::epsilon());
-// better use c++11 random library
-// static generator and distribution objects? static seed method?
-
 
 /*--------------------------------------------------------------------------*/
 
@@ -516,16 +1074,21 @@ public:
 
 /* like a stopwatch */
 
-class ofxTimer : ofxBaseControl {
+class ofxTimer : public ofxBaseControl {
 public:
     ofxTimer();
     virtual ~ofxTimer();
     /* interface implementation */
     virtual void init();
     virtual void update();
+    virtual void update(float dt);
     /* new functions */
     void reset();
     float getTime() const;
+    // snapshots (see ofxControlState.h)
+    virtual ofxControlStateType getStateType() const;
+    virtual void saveState(ofxControlStateWriter& writer) const;
+    virtual bool restoreState(ofxControlStateReader& reader);
 protected:
     float elapsed;
 };
@@ -533,66 +1096,43 @@ protected:
 
 /*--------------------------------------------------------------------------*/
 
-/// ofxControlBaseEvent
-/// abstract base class for different types of control events
-
-class ofxControlBaseEvent {
-public:
-    ofxControlBaseEvent(float _delay)
-        : delay(_delay), elapsed(0) {}
-	virtual ~ofxControlBaseEvent() {}
-	virtual void onTimeOut() = 0;
-	virtual bool compare(ofxControlBaseEvent * testObj) = 0;
-    float delay;
-    float elapsed;
-};
+/// ofxControlVarEvent / ofxControlFuncEvent
+/// function objects for the different types of control events (stored in an ofxControlCallback)
 
-/// clock event writing a value into a variable
+/// event writing a value into a variable
 
 template<typename T>
-class ofxControlVarEvent : public ofxControlBaseEvent {
+class ofxControlVarEvent {
 public:
-    ofxControlVarEvent(T* _var, const T & _val, float _delay = 0.0)
-        : ofxControlBaseEvent(_delay), var(_var), val(_val) {}
-    virtual ~ofxControlVarEvent() {}
-	virtual void onTimeOut(){
+    ofxControlVarEvent(T* _var, const T & _val)
+        : var(_var), val(_val) {}
+	void operator()(){
         if (var) {*var = val;}
 	}
-	virtual bool compare(ofxControlBaseEvent * testObj){
-		// test if testObj is of same type
-		if (auto * ptr = dynamic_cast<ofxControlVarEvent<T>*>(testObj)){
-			// test if both point to the same variable
-			return (var == ptr->var);
-		} else {
-			return false;
-		}
-	}	
+	bool matches(const ofxControlVarEvent & other) const {
+		// test if both point to the same variable
+		return (var == other.var);
+	}
 protected:
 	T* var;
-	T val;	
+	T val;
 };
 
 
-/// clock event calling a member function by a single argument
+/// event calling a member function by a single argument
 
 template<typename TArg, typename TReturn, typename TObj>
-class ofxControlFuncEvent : public ofxControlBaseEvent {
+class ofxControlFuncEvent {
 public:
-    ofxControlFuncEvent(TObj* _obj, TReturn(TObj::*_func)(TArg), const TArg & _arg, float _delay = 0.0)
-        : ofxControlBaseEvent(_delay), obj(_obj), func(_func), arg(_arg) {}
-    virtual ~ofxControlFuncEvent() {}
-	virtual void onTimeOut(){
+    ofxControlFuncEvent(TObj* _obj, TReturn(TObj::*_func)(TArg), const TArg & _arg)
+        : obj(_obj), func(_func), arg(_arg) {}
+	void operator()(){
         if (obj) {(obj->*func)(arg);}
 	}
-	virtual bool compare(ofxControlBaseEvent * testObj){
-		// test if testObj is of same type
-		if (auto * ptr = dynamic_cast<ofxControlFuncEvent<TArg, TReturn, TObj>*>(testObj)){
-			// test if both point to the same object and member function
-			return (obj == ptr->obj && func == ptr->func);
-		} else {
-			return false;
-		}
-	}	
+	bool matches(const ofxControlFuncEvent & other) const {
+		// test if both point to the same object and member function
+		return (obj == other.obj && func == other.func);
+	}
 protected:
     TObj* obj;
     TReturn(TObj::*func)(TArg);
@@ -602,27 +1142,18 @@ protected:
 // void specialization
 
 template<typename TReturn, typename TObj>
-class ofxControlFuncEvent<void, TReturn, TObj> : public ofxControlBaseEvent {
+class ofxControlFuncEvent<void, TReturn, TObj> {
 public:
-    ofxControlFuncEvent(TObj* _obj, TReturn(TObj::*_func)(), float _delay = 0.0)
-        : ofxControlBaseEvent(_delay), obj(_obj), func(_func) {}
-    virtual ~ofxControlFuncEvent() {}
-	virtual void onTimeOut(){
+    ofxControlFuncEvent(TObj* _obj, TReturn(TObj::*_func)())
+        : obj(_obj), func(_func) {}
+	void operator()(){
 		if (obj) {(obj->*func)();}
 	}
-	virtual bool compare(ofxControlBaseEvent * testObj){
-		// test if testObj is of same type
-		if (auto * ptr = dynamic_cast<ofxControlFuncEvent<void, TReturn, TObj>*>(testObj)){
-			// test if both point to the same object and member function
-			return (obj == ptr->obj && func == ptr->func);
-		} else {
-			return false;
-		}
-	}	
+	bool matches(const ofxControlFuncEvent & other) const {
+		// test if both point to the same object and member function
+		return (obj == other.obj && func == other.func);
+	}
 protected:
     TObj* obj;
-    TReturn(TObj::*func)();	
+    TReturn(TObj::*func)();
 };
-
-
-
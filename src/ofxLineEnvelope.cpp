@@ -0,0 +1,238 @@
+#include "ofxLineEnvelope.h"
+
+/// ofxLineEnvelope
+
+ofxLineEnvelopePtr ofxLineEnvelope::create(float startValue, const std::vector<Segment>& list){
+    std::shared_ptr<ofxLineEnvelope> envelope(new ofxLineEnvelope());
+    envelope->startValue = startValue;
+    auto& storage = envelope->storage;
+    storage.reserve(list.size());
+    envelope->shapers.resize(list.size());
+    double end = 0;
+    for (auto& s : list){
+        ofxLineEnvelopeSegment segment;
+        // same rules as ofxLine::setShape and ofxLine::addSegment
+        segment.target = s.target;
+        segment.time = (s.time >= 0.f) ? s.time : 0.f;
+        segment.onset = (s.onset >= 0.f) ? s.onset : 0.f;
+        segment.coeff = (s.coeff >= 0.f) ? s.coeff : 0.f;
+        segment.shape = s.shape;
+        segment.reserved = 0;
+        end += segment.onset + segment.time;
+        segment.end = end;
+        envelope->shapers[storage.size()].prepare(segment.shape, segment.coeff);
+        storage.push_back(segment);
+    }
+    envelope->segments = storage.data();
+    envelope->numSegments = storage.size();
+    return envelope;
+}
+
+ofxLineEnvelopePtr ofxLineEnvelope::load(const std::string& path){
+    auto file = ofxControlMappedFile::open(path);
+    if (!file){
+        return nullptr;
+    }
+    ofxControlFileHeader header;
+    auto records = _ofxControlReadFile(*file, ofxControlFileType::ENVELOPE, sizeof(ofxLineEnvelopeSegment), header);
+    if (!records){
+        return nullptr;
+    }
+    std::shared_ptr<ofxLineEnvelope> envelope(new ofxLineEnvelope());
+    envelope->startValue = (float)header.value;
+    envelope->segments = static_cast<const ofxLineEnvelopeSegment*>(records);
+    envelope->numSegments = (size_t)header.count;
+    envelope->file = std::move(file);
+    return envelope;
+}
+
+bool ofxLineEnvelope::save(const std::string& path) const {
+    return _ofxControlWriteFile(path, ofxControlFileType::ENVELOPE, segments,
+                                sizeof(ofxLineEnvelopeSegment), numSegments, startValue);
+}
+
+bool ofxLineEnvelope::isMapped() const {
+    return file != nullptr;
+}
+
+float ofxLineEnvelope::getStartValue() const {
+    return startValue;
+}
+
+float ofxLineEnvelope::getEndValue() const {
+    return numSegments ? segments[numSegments - 1].target : startValue;
+}
+
+double ofxLineEnvelope::getDuration() const {
+    return numSegments ? segments[numSegments - 1].end : 0.0;
+}
+
+size_t ofxLineEnvelope::getNumSegments() const {
+    return numSegments;
+}
+
+const ofxLineEnvelopeSegment& ofxLineEnvelope::getSegment(size_t index) const {
+    return segments[index];
+}
+
+float ofxLineEnvelope::valueAt(double t) const {
+    size_t index = findSegment(t);
+    if (index == numSegments){
+        return getEndValue();
+    }
+    if (shapers.empty()){
+        // mapped
+        _ofxLineShaper shaper;
+        shaper.prepare(segments[index].shape, segments[index].coeff);
+        return evalSegment(index, t, shaper);
+    }
+    return evalSegment(index, t, shapers[index]);
+}
+
+float ofxLineEnvelope::valueAt(double t, Cursor& cursor) const {
+    size_t n = numSegments;
+    size_t& hint = cursor.segment;
+    // while playing, we are usually still in the same segment or have just entered the next one
+    if (hint < n && t <= segments[hint].end && (hint == 0 || t > segments[hint - 1].end)){
+        // same segment
+    } else if (hint + 1 < n && t > segments[hint].end && t <= segments[hint + 1].end){
+        ++hint;
+    } else {
+        hint = findSegment(t);
+        if (hint == n){
+            return getEndValue();
+        }
+    }
+    if (shapers.empty()){
+        // mapped: prepare the shape once per segment
+        if (cursor.shaperSegment != hint){
+            cursor.shaper.prepare(segments[hint].shape, segments[hint].coeff);
+            cursor.shaperSegment = hint;
+        }
+        return evalSegment(hint, t, cursor.shaper);
+    }
+    return evalSegment(hint, t, shapers[hint]);
+}
+
+size_t ofxLineEnvelope::findSegment(double t) const {
+    // first segment which ends at or after 't'
+    size_t lo = 0;
+    size_t hi = numSegments;
+    while (lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if (segments[mid].end < t){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+float ofxLineEnvelope::evalSegment(size_t index, double t, const _ofxLineShaper& shaper) const {
+    const ofxLineEnvelopeSegment& segment = segments[index];
+    float start = (index > 0) ? segments[index - 1].target : startValue;
+    double ramp = t - (segment.end - segment.time);
+    if (ramp <= 0.0){
+        return start; // waiting for the onset
+    } else if (ramp >= segment.time){
+        return segment.target;
+    } else {
+        return start + (segment.target - start) * shaper.direct(ramp / segment.time);
+    }
+}
+
+
+/*-------------------------------------------------------------------*/
+
+/// ofxLinePlayer
+
+ofxLinePlayer::ofxLinePlayer(){
+    init();
+}
+
+ofxLinePlayer::ofxLinePlayer(ofxLineEnvelopePtr newEnvelope){
+    init();
+    setEnvelope(std::move(newEnvelope));
+}
+
+ofxLinePlayer::~ofxLinePlayer(){}
+
+void ofxLinePlayer::init(){
+    ofxBaseControl::init();
+    time = 0;
+    cursor = ofxLineEnvelope::Cursor();
+    bLoop = false;
+    bFinished = false;
+    value = envelope ? envelope->getStartValue() : 0.f;
+}
+
+void ofxLinePlayer::update(){
+    ofxLinePlayer::update((float)timeDomain->getDeltaTime());
+}
+
+void ofxLinePlayer::update(float dt){
+    if (bRunning && envelope){
+        double duration = envelope->getDuration();
+        value = envelope->valueAt(time, cursor);
+        // a jump at the very end only takes effect after its end time (like in ofxLine::update)
+        bFinished = !bLoop && (time > duration || (time == duration && value == envelope->getEndValue()));
+        time += (double)dt * speed;
+        if (bLoop && time >= duration){
+            time = (duration > 0.0) ? std::fmod(time, duration) : 0.0;
+            cursor.segment = 0;
+        }
+    }
+}
+
+float ofxLinePlayer::out() const {
+    return value;
+}
+
+void ofxLinePlayer::setEnvelope(ofxLineEnvelopePtr newEnvelope){
+    envelope = std::move(newEnvelope);
+    time = 0;
+    cursor = ofxLineEnvelope::Cursor();
+    bFinished = false;
+    if (envelope){
+        value = envelope->getStartValue();
+        wake();
+    }
+}
+
+const ofxLineEnvelopePtr& ofxLinePlayer::getEnvelope() const {
+    return envelope;
+}
+
+void ofxLinePlayer::setTime(double t){
+    time = std::max(0.0, t);
+    if (envelope){
+        double duration = envelope->getDuration();
+        if (bLoop && time >= duration){
+            time = (duration > 0.0) ? std::fmod(time, duration) : 0.0;
+        }
+        value = envelope->valueAt(time, cursor);
+        bFinished = !bLoop && (time > duration || (time == duration && value == envelope->getEndValue()));
+        wake();
+    }
+}
+
+double ofxLinePlayer::getTime() const {
+    return time;
+}
+
+void ofxLinePlayer::setLoop(bool loop){
+    bLoop = loop;
+    if (loop){
+        bFinished = false;
+        wake();
+    }
+}
+
+bool ofxLinePlayer::isLooping() const {
+    return bLoop;
+}
+
+bool ofxLinePlayer::isFinished() const {
+    return bFinished;
+}
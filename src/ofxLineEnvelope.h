@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ofxControlUtils.h"
+#include "ofxControlMappedFile.h"
+#include <memory>
+#include <string>
+#include <type_traits>
+
+/// ofxLineEnvelope
+/* An immutable ("compiled") list of line segments which can be shared by any number of ofxLinePlayer objects.
+ * The segments work exactly like the segments of ofxLine: each one waits for its onset and then ramps from the
+ * previous target to its own target in 'time' seconds, along its shape. Everything which can be computed
+ * up front is computed once in 'create': the time axis (a prefix sum of all onsets and ramp times)
+ * and the constants of the shapes.
+ *
+ * Envelopes are always handled by ofxLineEnvelopePtr (a shared pointer to a const envelope), so 1000 fixtures
+ * playing the same fade share one segment list, and the envelope goes away when the last player lets go of it.
+ * Since they are never modified, they can be read from several threads at the same time.
+ *
+ * Big envelopes (e.g. hundreds of thousands of breakpoints of a show file) can be saved to a binary file ('save')
+ * and mapped into memory later ('load', see ofxControlMappedFile). A mapped envelope is played directly from the file:
+ * loading takes constant time and only the pages which are actually played become resident.
+ * Mapped envelopes don't store the prepared shapes; players prepare the shape of their current segment themselves. */
+
+// a compiled segment of an ofxLineEnvelope
+struct ofxLineEnvelopeSegment {
+    // end of the segment on the time axis of the envelope (sum of the onsets and ramp times up to this segment)
+    double end;
+    float target;
+    // ramp time
+    float time;
+    // time to wait before the ramp starts
+    float onset;
+    float coeff;
+    ofxLineShape shape;
+    // padding (always 0)
+    uint32_t reserved;
+};
+
+// the segments are the records of the binary file format (see ofxControlMappedFile.h)
+static_assert(sizeof(ofxLineShape) == 4, "ofxLineEnvelopeSegment: unexpected size of ofxLineShape");
+static_assert(sizeof(ofxLineEnvelopeSegment) == 32, "ofxLineEnvelopeSegment: unexpected size");
+static_assert(std::is_trivial<ofxLineEnvelopeSegment>::value, "ofxLineEnvelopeSegment: must be a trivial type");
+
+class ofxLineEnvelope;
+typedef std::shared_ptr<const ofxLineEnvelope> ofxLineEnvelopePtr;
+
+class ofxLineEnvelope {
+public:
+    // a segment as passed to 'create' (the same parameters as ofxLine::setShape and ofxLine::addSegment)
+    struct Segment {
+        Segment(float _target, float _time = 0, float _onset = 0, ofxLineShape _shape = ofxLineShape::LIN, float _coeff = 0)
+            : target(_target), time(_time), onset(_onset), shape(_shape), coeff(_coeff) {}
+        float target;
+        float time;
+        float onset;
+        ofxLineShape shape;
+        float coeff;
+    };
+    // playing position of an ofxLinePlayer: the segment of the last lookup
+    // and, for mapped envelopes, the prepared shape of that segment
+    struct Cursor {
+        size_t segment = 0;
+        size_t shaperSegment = std::numeric_limits<size_t>::max();
+        _ofxLineShaper shaper;
+    };
+    // compile a list of segments, starting at 'startValue'
+    static ofxLineEnvelopePtr create(float startValue, const std::vector<Segment>& segments);
+    // map an envelope file written by 'save', returns nullptr if the file can't be opened or is not a valid envelope file
+    static ofxLineEnvelopePtr load(const std::string& path);
+    // write the envelope to a binary file, returns false on failure
+    bool save(const std::string& path) const;
+    // true if the segments are read from a mapped file
+    bool isMapped() const;
+
+    float getStartValue() const;
+    // target of the last segment (or the start value if there are no segments)
+    float getEndValue() const;
+    // end of the last segment
+    double getDuration() const;
+    size_t getNumSegments() const;
+    // no range checking!
+    const ofxLineEnvelopeSegment& getSegment(size_t index) const;
+    // value at 't' seconds after the start. O(log n) in the number of segments.
+    float valueAt(double t) const;
+    // same, but first tries the segment of the cursor and the one after (O(1) when playing), then moves the cursor to 't'.
+    float valueAt(double t, Cursor& cursor) const;
+    // index of the segment containing 't', or getNumSegments() if 't' lies behind the end
+    size_t findSegment(double t) const;
+protected:
+    ofxLineEnvelope() {}
+    float startValue;
+    // points either to 'storage' or into the mapped file
+    const ofxLineEnvelopeSegment* segments;
+    size_t numSegments;
+    std::vector<ofxLineEnvelopeSegment> storage;
+    ofxControlMappedFilePtr file;
+    // prepared shapes (one per segment, empty for mapped envelopes)
+    std::vector<_ofxLineShaper> shapers;
+    float evalSegment(size_t index, double t, const _ofxLineShaper& shaper) const;
+};
+
+
+/// ofxLinePlayer
+/* Plays an ofxLineEnvelope. A player only holds a reference to the envelope, a time cursor and the output value,
+ * so you can have thousands of them playing the same envelope, each at its own position and speed.
+ * Like ofxLine, the value after an update is the value at the time *before* the update,
+ * so a player and an ofxLine with the same segments produce the same output. */
+
+class ofxLinePlayer : public ofxBaseControl {
+public:
+    ofxLinePlayer();
+    ofxLinePlayer(ofxLineEnvelopePtr envelope);
+    virtual ~ofxLinePlayer();
+
+    /* interface implementation */
+    // rewind and stop looping (keeps the envelope)
+    virtual void init();
+    virtual void update();
+    virtual void update(float dt);
+
+    /* individual functions */
+    float out() const;
+    // set a new envelope and rewind. nullptr stops the player (the value is kept).
+    void setEnvelope(ofxLineEnvelopePtr newEnvelope);
+    const ofxLineEnvelopePtr& getEnvelope() const;
+    // jump to a position (in seconds from the start of the envelope)
+    void setTime(double t);
+    double getTime() const;
+    // start over at the end of the envelope
+    void setLoop(bool loop);
+    bool isLooping() const;
+    // true if the end of the envelope has been reached (never when looping)
+    bool isFinished() const;
+    // true if there is no envelope, it has finished or the player is paused
+    bool isIdle() const { return !bRunning || !envelope || isFinished(); }
+protected:
+    ofxLineEnvelopePtr envelope;
+    double time;
+    float value;
+    // position of the last update
+    ofxLineEnvelope::Cursor cursor;
+    bool bLoop;
+    // the last value was taken at (or behind) the end of the envelope
+    bool bFinished;
+};
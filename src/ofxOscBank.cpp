@@ -0,0 +1,424 @@
+#include "ofxOscBank.h"
+
+/// ofxOscBank
+
+namespace {
+    const uint32_t npos = ofxControlSlotMap<_ofxOscBankListener>::npos;
+}
+
+ofxOscBank::ofxOscBank(){
+    noiseStream = ofxControl::newStream();
+    init();
+}
+
+ofxOscBank::ofxOscBank(int numVoices){
+    noiseStream = ofxControl::newStream();
+    init();
+    setNumVoices(numVoices);
+}
+
+ofxOscBank::~ofxOscBank(){
+}
+
+void ofxOscBank::init(){
+    ofxBaseControl::init();
+    eventMap.clear();
+    std::fill(freq.begin(), freq.end(), 1.f);
+    std::fill(phase.begin(), phase.end(), 0.f);
+    std::fill(offset.begin(), offset.end(), 0.f);
+    std::fill(wrapped.begin(), wrapped.end(), 0.f);
+    std::fill(width.begin(), width.end(), 0.5f);
+    std::fill(vertex.begin(), vertex.end(), 0.5f);
+    std::fill(waveform.begin(), waveform.end(), ofxOscWaveform::SAW);
+    std::fill(counter.begin(), counter.end(), 0);
+    std::fill(noiseIndex.begin(), noiseIndex.end(), 0);
+    std::fill(reset.begin(), reset.end(), 1);
+    std::fill(firstListener.begin(), firstListener.end(), npos);
+    std::fill(lastListener.begin(), lastListener.end(), npos);
+    lastScale = 0;
+    maxFreq = 1.f;
+    bRunsDirty = true;
+}
+
+void ofxOscBank::update(){
+    ofxOscBank::update((float)timeDomain->getDeltaTime());
+}
+
+void ofxOscBank::update(float dt){
+    if (bRunning){
+        size_t n = freq.size();
+        // wrapped phase of all voices
+        ofxControlSimd::frac(nextWrapped.data(), phase.data(), offset.data(), n);
+        // detect the start of a new period (same rules as ofxBaseOsc)
+        wrappedVoices.clear();
+        wrapOffsets.clear();
+        // only frequencies above the update rate can start more than one period per update
+        bool bMulti = maxFreq * std::fabs(lastScale) >= 1.f;
+        for (size_t i = 0; i < n; ++i){
+            float old = wrapped[i];
+            float w = nextWrapped[i];
+            bool bWrapped = (freq[i] > 0.f && w <= old) || (freq[i] < 0.f && w >= old);
+            if (!reset[i] && (bWrapped || bMulti)){
+                float inc = freq[i] * lastScale;
+                int64_t periods = bMulti ? std::abs(_ofxOscNumPeriods(old, w, inc)) : 1;
+                counter[i] += (int)periods;
+                if (freq[i] > 0.f){
+                    noiseIndex[i] += (uint32_t)periods;
+                } else {
+                    noiseIndex[i] -= (uint32_t)periods;
+                }
+                if (firstListener[i] != npos){
+                    for (int64_t k = 0; k < periods; ++k){
+                        wrappedVoices.push_back((int)i);
+                        wrapOffsets.push_back(_ofxOscPeriodPosition(old, w, freq[i] > 0.f, inc, k, periods) * dt);
+                    }
+                }
+            }
+            reset[i] = 0;
+        }
+        wrapped.swap(nextWrapped);
+        // advance all phases
+        lastScale = speed * dt;
+        ofxControlSimd::phasor(phase.data(), freq.data(), lastScale, n);
+
+        /* fire events. the handles are collected first, so listeners which are added by a callback are not called
+         * before the next period, and the map is held, so a callback can remove listeners (even itself) while it is called. */
+        eventMap.hold();
+        for (size_t k = 0; k < wrappedVoices.size(); ++k){
+            int voice = wrappedVoices[k];
+            if (voice >= (int)firstListener.size()){
+                break; // voices have been removed by a callback
+            }
+            // used as a stack (see ofxBaseOsc::fireEvents)
+            size_t start = firing.size();
+            for (uint32_t index = firstListener[voice]; index != npos; index = eventMap.at(index).next){
+                firing.push_back(eventMap.handle(index));
+            }
+            size_t end = firing.size();
+            for (size_t i = start; i < end; ++i){
+                _ofxOscBankListener* listener = eventMap.get(firing[i]);
+                if (listener){
+                    ofxControl::fire(listener->callback, wrapOffsets[k]);
+                }
+            }
+            firing.resize(start);
+        }
+        eventMap.release();
+    }
+}
+
+void ofxOscBank::setNumVoices(int numVoices){
+    size_t n = std::max(0, numVoices);
+    if (n < freq.size()){
+        // remove the listeners of the removed voices
+        for (size_t i = n; i < firstListener.size(); ++i){
+            removeAll((int)i);
+        }
+    }
+    freq.resize(n, 1.f);
+    maxFreq = std::max(maxFreq, 1.f);
+    phase.resize(n, 0.f);
+    offset.resize(n, 0.f);
+    wrapped.resize(n, 0.f);
+    width.resize(n, 0.5f);
+    vertex.resize(n, 0.5f);
+    waveform.resize(n, ofxOscWaveform::SAW);
+    counter.resize(n, 0);
+    noiseIndex.resize(n, 0);
+    reset.resize(n, 1);
+    firstListener.resize(n, npos);
+    lastListener.resize(n, npos);
+    nextWrapped.resize(n);
+    bRunsDirty = true;
+}
+
+int ofxOscBank::getNumVoices() const {
+    return (int)freq.size();
+}
+
+void ofxOscBank::setFrequency(int voice, float hz){
+    freq[voice] = hz;
+    maxFreq = std::max(maxFreq, std::fabs(hz));
+}
+
+float ofxOscBank::getFrequency(int voice) const {
+    return freq[voice];
+}
+
+void ofxOscBank::setPeriod(int voice, float seconds){
+    freq[voice] = 1.f/seconds;
+    maxFreq = std::max(maxFreq, std::fabs(freq[voice]));
+}
+
+float ofxOscBank::getPeriod(int voice) const {
+    return 1.f/freq[voice];
+}
+
+// will *not* trigger events
+void ofxOscBank::setPhase(int voice, float newPhase){
+    phase[voice] = newPhase;
+    reset[voice] = 1;
+}
+
+float ofxOscBank::getPhase(int voice) const {
+    return wrapped[voice];
+}
+
+void ofxOscBank::setPhaseOffset(int voice, float newOffset){
+    offset[voice] = newOffset;
+}
+
+float ofxOscBank::getPhaseOffset(int voice) const {
+    return offset[voice];
+}
+
+void ofxOscBank::setWaveform(int voice, ofxOscWaveform newWaveform){
+    if (waveform[voice] != newWaveform){
+        waveform[voice] = newWaveform;
+        bRunsDirty = true;
+    }
+}
+
+ofxOscWaveform ofxOscBank::getWaveform(int voice) const {
+    return waveform[voice];
+}
+
+void ofxOscBank::setNoiseStream(uint32_t id){
+    noiseStream = id;
+}
+
+uint32_t ofxOscBank::getNoiseStream() const {
+    return noiseStream;
+}
+
+void ofxOscBank::setPulseWidth(int voice, float w){
+    width[voice] = std::max(0.f, std::min(1.f, w));
+}
+
+float ofxOscBank::getPulseWidth(int voice) const {
+    return width[voice];
+}
+
+void ofxOscBank::setVertex(int voice, float v){
+    vertex[voice] = std::max(0.f, std::min(1.f, v));
+}
+
+float ofxOscBank::getVertex(int voice) const {
+    return vertex[voice];
+}
+
+void ofxOscBank::setFrequencies(float hz){
+    std::fill(freq.begin(), freq.end(), hz);
+    maxFreq = std::fabs(hz);
+}
+
+void ofxOscBank::setWaveforms(ofxOscWaveform newWaveform){
+    std::fill(waveform.begin(), waveform.end(), newWaveform);
+    bRunsDirty = true;
+}
+
+float ofxOscBank::out(int voice) const {
+    float w = wrapped[voice];
+    switch (waveform[voice]){
+    case ofxOscWaveform::SIN:
+        return ofxControl::isFast() ? ofxControlFastMath::sin2pi(w) : std::sin(w*OFXCONTROL_TWO_PI);
+    case ofxOscWaveform::COS:
+        return ofxControl::isFast() ? ofxControlFastMath::cos2pi(w) : std::cos(w*OFXCONTROL_TWO_PI);
+    case ofxOscWaveform::PULSE:
+        return (w < width[voice]);
+    case ofxOscWaveform::TRI:
+    {
+        // same shape as ofxTriOsc
+        float v = vertex[voice];
+        if (w < v){
+            return w / v;
+        } else {
+            return (v < 1.f) ? (1.f - w) / (1.f - v) : 1.f;
+        }
+    }
+    case ofxOscWaveform::NOISE:
+    {
+        // same as ofxControlSimd::noise
+        uint32_t key = ofxControlRandom::hash(ofxControlRandom::hash(ofxControl::getSeed(), noiseStream), (uint32_t)voice);
+        return ofxControlRandom::noise(key, noiseIndex[voice], w);
+    }
+    default:
+        return w;
+    }
+}
+
+void ofxOscBank::process(float* dst) const {
+    process(dst, 0, getNumVoices());
+}
+
+void ofxOscBank::process(float* dst, int first, int count) const {
+    if (bRunsDirty){
+        updateRuns();
+    }
+    int end = first + count;
+    bool fast = ofxControl::isFast();
+    // evaluate each run of voices with the same waveform in one go
+    for (auto& run : runs){
+        int begin = std::max(run.first, first);
+        int last = std::min(run.end, end);
+        if (begin >= last){
+            continue;
+        }
+        const float* w = wrapped.data() + begin;
+        float* y = dst + (begin - first);
+        int n = last - begin;
+        switch (run.waveform){
+        case ofxOscWaveform::SIN:
+            if (fast){
+                ofxControlSimd::sin2pi(y, w, 0.f, n);
+            } else {
+                for (int i = 0; i < n; ++i){
+                    y[i] = std::sin(w[i]*OFXCONTROL_TWO_PI);
+                }
+            }
+            break;
+        case ofxOscWaveform::COS:
+            if (fast){
+                ofxControlSimd::sin2pi(y, w, 0.25f, n);
+            } else {
+                for (int i = 0; i < n; ++i){
+                    y[i] = std::cos(w[i]*OFXCONTROL_TWO_PI);
+                }
+            }
+            break;
+        case ofxOscWaveform::PULSE:
+        {
+            const float* pw = width.data() + begin;
+            for (int i = 0; i < n; ++i){
+                y[i] = (w[i] < pw[i]) ? 1.f : 0.f;
+            }
+            break;
+        }
+        case ofxOscWaveform::TRI:
+        {
+            const float* v = vertex.data() + begin;
+            for (int i = 0; i < n; ++i){
+                // same as 'out', without branches (so the loop can be vectorized)
+                float rise = (v[i] > 0.f) ? w[i] / v[i] : 1.f;
+                float fall = (v[i] < 1.f) ? (1.f - w[i]) / (1.f - v[i]) : 1.f;
+                y[i] = (w[i] < v[i]) ? rise : fall;
+            }
+            break;
+        }
+        case ofxOscWaveform::NOISE:
+            ofxControlSimd::noise(y, w, noiseIndex.data() + begin,
+                                  ofxControlRandom::hash(ofxControl::getSeed(), noiseStream), (uint32_t)begin, n);
+            break;
+        default:
+            std::copy(w, w + n, y);
+            break;
+        }
+    }
+}
+
+ofxControlHandle ofxOscBank::insert(int voice, ofxControlCallback&& callback){
+    _ofxOscBankListener listener;
+    listener.callback = std::move(callback);
+    listener.voice = voice;
+    listener.prev = lastListener[voice];
+    listener.next = npos;
+    ofxControlHandle h = eventMap.insert(std::move(listener));
+    // append to the list of the voice
+    if (lastListener[voice] != npos){
+        eventMap.at(lastListener[voice]).next = h.index;
+    } else {
+        firstListener[voice] = h.index;
+    }
+    lastListener[voice] = h.index;
+    return h;
+}
+
+void ofxOscBank::unlink(uint32_t index){
+    _ofxOscBankListener& listener = eventMap.at(index);
+    if (listener.prev != npos){
+        eventMap.at(listener.prev).next = listener.next;
+    } else {
+        firstListener[listener.voice] = listener.next;
+    }
+    if (listener.next != npos){
+        eventMap.at(listener.next).prev = listener.prev;
+    } else {
+        lastListener[listener.voice] = listener.prev;
+    }
+    eventMap.eraseAt(index);
+}
+
+bool ofxOscBank::remove(ofxControlHandle handle){
+    if (eventMap.contains(handle)){
+        unlink(handle.index);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool ofxOscBank::isAdded(ofxControlHandle handle) const {
+    return eventMap.contains(handle);
+}
+
+void ofxOscBank::removeAll(int voice){
+    uint32_t index = firstListener[voice];
+    while (index != npos){
+        uint32_t next = eventMap.at(index).next;
+        eventMap.eraseAt(index);
+        index = next;
+    }
+    firstListener[voice] = npos;
+    lastListener[voice] = npos;
+}
+
+void ofxOscBank::removeAll(){
+    eventMap.clear();
+    std::fill(firstListener.begin(), firstListener.end(), npos);
+    std::fill(lastListener.begin(), lastListener.end(), npos);
+}
+
+void ofxOscBank::reserve(int numVoices, int numListeners){
+    size_t n = std::max(0, numVoices);
+    freq.reserve(n);
+    phase.reserve(n);
+    offset.reserve(n);
+    wrapped.reserve(n);
+    width.reserve(n);
+    vertex.reserve(n);
+    waveform.reserve(n);
+    counter.reserve(n);
+    noiseIndex.reserve(n);
+    reset.reserve(n);
+    firstListener.reserve(n);
+    lastListener.reserve(n);
+    nextWrapped.reserve(n);
+    wrappedVoices.reserve(n);
+    wrapOffsets.reserve(n);
+    eventMap.reserve(std::max(0, numListeners));
+}
+
+int ofxOscBank::getCounter(int voice) const {
+    return counter[voice];
+}
+
+void ofxOscBank::resetCounter(int voice){
+    counter[voice] = 0;
+}
+
+void ofxOscBank::updateRuns() const {
+    runs.clear();
+    int n = getNumVoices();
+    int i = 0;
+    while (i < n){
+        Run run;
+        run.first = i;
+        run.waveform = waveform[i];
+        while (i < n && waveform[i] == run.waveform){
+            ++i;
+        }
+        run.end = i;
+        runs.push_back(run);
+    }
+    bRunsDirty = false;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "ofxControlUtils.h"
+
+/// ofxOscBank
+/* A bank of oscillators (voices) sharing the same speed, stored as a struct of arrays.
+ * Instead of updating thousands of ofxBaseOsc objects one by one, all phases are advanced
+ * in a single vectorized pass (see ofxControlSimd) and the outputs are evaluated in batch
+ * into a buffer provided by the caller.
+ *
+ * Every voice has its own frequency, phase, phase offset and waveform (plus pulse width / vertex),
+ * which behave exactly like the corresponding settings of ofxBaseOsc, ofxPulseOsc and ofxTriOsc.
+ * Voices are addressed by index (0 to getNumVoices() - 1). There's no range checking!
+ *
+ * NOISE voices work like ofxNoiseOsc with the default settings (uniform 0 - 1, linear interpolation).
+ * Every voice has its own random stream, derived from the stream id of the bank (see 'setNoiseStream') and the voice index,
+ * and the random values of all NOISE voices are computed in batch by a SIMD kernel (see ofxControlSimd::noise).
+ *
+ * Event listeners are installed per voice and called right before the voice starts a new period.
+ * They are called after all voices have been updated, in ascending voice order (and in insertion order
+ * for listeners of the same voice). Voices without listeners don't cost anything beyond the phase update. */
+
+enum class ofxOscWaveform : uint8_t {
+    SAW,
+    SIN,
+    COS,
+    PULSE,
+    TRI,
+    NOISE
+};
+
+// an event listener for a single voice of an ofxOscBank
+struct _ofxOscBankListener {
+    ofxControlCallback callback;
+    int voice;
+    // links to the other listeners of the same voice (slot indices)
+    uint32_t prev;
+    uint32_t next;
+};
+
+class ofxOscBank : public ofxBaseControl {
+public:
+    ofxOscBank();
+    ofxOscBank(int numVoices);
+    virtual ~ofxOscBank();
+
+    /* interface implementation */
+    // reset all voices to their default settings and remove all event listeners (keeps the number of voices)
+    virtual void init();
+    virtual void update();
+    virtual void update(float dt);
+
+    /* individual functions */
+    // set the number of voices. new voices get the default settings (saw, 1 Hz),
+    // removing voices also removes their event listeners.
+    void setNumVoices(int numVoices);
+    int getNumVoices() const;
+
+    void setFrequency(int voice, float hz);
+    float getFrequency(int voice) const;
+    void setPeriod(int voice, float seconds);
+    float getPeriod(int voice) const;
+    void setPhase(int voice, float newPhase); // will *not* trigger events
+    float getPhase(int voice) const; // wrapped phase (including the phase offset)
+    void setPhaseOffset(int voice, float newOffset);
+    float getPhaseOffset(int voice) const;
+    void setWaveform(int voice, ofxOscWaveform waveform);
+    ofxOscWaveform getWaveform(int voice) const;
+    // pulse width for PULSE voices (0 - 1)
+    void setPulseWidth(int voice, float width);
+    float getPulseWidth(int voice) const;
+    // vertex for TRI voices (0 - 1)
+    void setVertex(int voice, float v);
+    float getVertex(int voice) const;
+    // set the frequency / waveform for all voices
+    void setFrequencies(float hz);
+    void setWaveforms(ofxOscWaveform waveform);
+    // random stream of the NOISE voices (voice i uses sub-stream i). every bank gets a new stream id on construction.
+    void setNoiseStream(uint32_t id);
+    uint32_t getNoiseStream() const;
+
+    // get the output of a single voice
+    float out(int voice) const;
+    // write the outputs of all voices to a buffer, which must hold at least getNumVoices() floats
+    void process(float* dst) const;
+    // write the outputs of the voices [first, first + count) to a buffer (no range checking)
+    void process(float* dst, int first, int count) const;
+
+    // add event listeners for a voice, being called right before the start of a new period
+    // writing a value to a variable
+    template<typename T>
+    ofxControlHandle add(int voice, T* var, const T & value);
+    // calling a member function with no arguments
+    template<typename TReturn, typename TObj>
+    ofxControlHandle add(int voice, TObj* obj, TReturn(TObj::*func)());
+    // calling a member function by a single argument
+    template<typename TArg, typename TReturn, typename TObj>
+    ofxControlHandle add(int voice, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg);
+    // calling any function object (e.g. a lambda)
+    template<typename TFunc>
+    ofxControlHandle add(int voice, TFunc&& func);
+
+    // remove a single event listener by its handle (O(1)), returns false if it has already been removed
+    bool remove(ofxControlHandle handle);
+    // check if an event listener is still installed
+    bool isAdded(ofxControlHandle handle) const;
+    // remove all event listeners of a voice
+    void removeAll(int voice);
+    // remove all event listeners
+    void removeAll();
+    // preallocate space for a number of voices and event listeners
+    void reserve(int numVoices, int numListeners = 0);
+
+    int getCounter(int voice) const;
+    void resetCounter(int voice);
+protected:
+    // voice parameters and state (aligned for the SIMD kernels)
+    ofxControlAlignedVector<float> freq;
+    ofxControlAlignedVector<float> phase;
+    ofxControlAlignedVector<float> offset;
+    ofxControlAlignedVector<float> wrapped;
+    ofxControlAlignedVector<float> width;
+    ofxControlAlignedVector<float> vertex;
+    std::vector<ofxOscWaveform> waveform;
+    std::vector<int> counter;
+    // NOISE voices: number of the current period (counting down for negative frequencies)
+    ofxControlAlignedVector<uint32_t> noiseIndex;
+    uint32_t noiseStream;
+    // voices which must not trigger events on the next update (see 'setPhase')
+    std::vector<uint8_t> reset;
+    // first and last event listener of each voice (slot indices)
+    std::vector<uint32_t> firstListener;
+    std::vector<uint32_t> lastListener;
+    ofxControlSlotMap<_ofxOscBankListener> eventMap;
+
+    // consecutive voices with the same waveform, rebuilt lazily after the waveforms have changed
+    struct Run {
+        int first;
+        int end;
+        ofxOscWaveform waveform;
+    };
+    mutable std::vector<Run> runs;
+    mutable bool bRunsDirty;
+    // scratch buffers for 'update'
+    ofxControlAlignedVector<float> nextWrapped;
+    std::vector<int> wrappedVoices;
+    // time offsets of the new periods of 'wrappedVoices'
+    std::vector<float> wrapOffsets;
+    // phase increment per Hz of the last update
+    float lastScale;
+    // upper bound for the absolute frequencies of all voices
+    float maxFreq;
+    std::vector<ofxControlHandle> firing;
+
+    ofxControlHandle insert(int voice, ofxControlCallback&& callback);
+    void unlink(uint32_t index);
+    void updateRuns() const;
+};
+
+// add a new event listener for a voice, writing a value to a variable
+template<typename T>
+ofxControlHandle ofxOscBank::add(int voice, T* var, const T & value){
+    return insert(voice, ofxControlVarEvent<T>(var, value));
+}
+// add a new event listener for a voice, calling a member function with no arguments
+template<typename TReturn, typename TObj>
+ofxControlHandle ofxOscBank::add(int voice, TObj* obj, TReturn(TObj::*func)()){
+    return insert(voice, ofxControlFuncEvent<void, TReturn, TObj>(obj, func));
+}
+// add a new event listener for a voice, calling a member function by a single argument
+template<typename TArg, typename TReturn, typename TObj>
+ofxControlHandle ofxOscBank::add(int voice, TObj* obj, TReturn(TObj::*func)(TArg), const TArg & arg){
+    return insert(voice, ofxControlFuncEvent<TArg, TReturn, TObj>(obj, func, arg));
+}
+// add a new event listener for a voice, calling any function object
+template<typename TFunc>
+ofxControlHandle ofxOscBank::add(int voice, TFunc&& func){
+    return insert(voice, ofxControlCallback(std::forward<TFunc>(func)));
+}